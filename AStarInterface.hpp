@@ -1,6 +1,8 @@
 #pragma once
+#include "SearchArena.hpp"
 #include <memory>
 #include <queue>
+#include <cstdint>
 
 // A class to be used as an interface to the state of the search.
 class IState
@@ -13,12 +15,21 @@ public:
 
 	// Returns the heuristic property.
 	int Heuristic() const { return heuristic; }
+	// Returns the hash property (used by the solver to detect already reached states).
+	std::uint64_t Hash() const { return hash; }
 	// Allocates and initializes a clone of this state.
 	virtual IState* Clone() const = 0;
 
+	// The states are allocated from the current search arena, if there is one.
+	static void* operator new(std::size_t size) { return SearchArena::AllocateObject(size); }
+	static void operator delete(void* memory) { SearchArena::FreeObject(memory); }
+
 protected:
 	// The heuristic value of this state (how close is it to the solution).
 	int heuristic = -1;
+	// The hash of this state, equal states must have equal hashes. Only used if the problem supports hashing
+	// (see IProblem::SupportsHashing).
+	std::uint64_t hash = 0;
 };
 
 // A structure that contains the cost of the action.
@@ -35,6 +46,40 @@ public:
 
 	// Allocates and initializes a clone of this action.
 	virtual IAction* Clone() const = 0;
+
+	// The actions are allocated from the current search arena, if there is one.
+	static void* operator new(std::size_t size) { return SearchArena::AllocateObject(size); }
+	static void operator delete(void* memory) { SearchArena::FreeObject(memory); }
+};
+
+// A successor of a state that is only built when the search decides to keep it.
+class ISuccessor
+{
+public:
+	// Virtual destructor.
+	virtual ~ISuccessor() {}
+
+	// Returns the action that leads to the successor, its cost is known without building the successor.
+	virtual IAction const& GetAction() const = 0;
+	// Evaluates the heuristic of the successor state.
+	virtual int Heuristic() = 0;
+	// Evaluates the hash of the successor state.
+	virtual std::uint64_t Hash() = 0;
+	// Allocates the successor state.
+	virtual IState* MakeState() = 0;
+	// Allocates the action that leads to the successor.
+	virtual IAction* MakeAction() = 0;
+};
+
+// An object that receives the successors of a state one by one.
+class ISuccessorVisitor
+{
+public:
+	// Virtual destructor.
+	virtual ~ISuccessorVisitor() {}
+
+	// Called for every successor, the successor can only be used during the call.
+	virtual void Visit(ISuccessor& successor) = 0;
 };
 
 // A structure that contains the definition of the problem that needs state search solving.
@@ -53,4 +98,13 @@ public:
 	// Should enumerate all actions that can be taken from the input state.
 	virtual void EnumeratePossibleActions(IState const* state,
 		std::queue<std::pair<IAction*, IState*>>& possibleActions) const = 0;
+	// Should return true, if the problem implements EnumerateSuccessors.
+	virtual bool SupportsLazySuccessors() const { return false; }
+	// Should return true, if the states set their hash. The solver then detects the already reached states
+	// by the hashes alone, so different states must not share a hash (64-bit hashes of good quality make that
+	// unlikely enough). Otherwise the states are not compared at all and the states reached again are searched again.
+	virtual bool SupportsHashing() const { return false; }
+	// Should pass all the successors of the input state to the visitor, without building
+	// the ones the visitor does not ask for.
+	virtual void EnumerateSuccessors(IState const* /*state*/, ISuccessorVisitor& /*visitor*/) const {}
 };
@@ -1,38 +1,32 @@
 #pragma once
-#include "AStarInterface.hpp"
-#include <memory>
+#include <utility>
 
+// A node of the search tree. The node only knows the last action, the whole path is
+// obtained by following the parents up to the initial node.
+// The nodes are allocated from the arena of the search and released all at once, without calling their destructors.
+template <typename State, typename Action>
 struct Node
 {
-	Node() = default;
-	Node(Node* other)
-	{
-		actionsToReach = std::move(other->actionsToReach);
-		state = std::move(other->state);
-		depth = other->depth;
-		pathCost = other->pathCost;
-		heuristicCost = other->heuristicCost;
-	}
-	Node(Node const* other)
-	{
-		actionsToReach.resize(other->actionsToReach.size());
-		for (int i = 0; i < other->actionsToReach.size(); ++i)
-		{
-			actionsToReach[i] = std::unique_ptr<IAction>(other->actionsToReach[i]->Clone());
-		}
-		state = std::unique_ptr<IState>(other->state->Clone());
-		depth = other->depth;
-		pathCost = other->pathCost;
-		heuristicCost = other->heuristicCost;
-	}
-	// The actions that were taken to reach this node.
-	std::vector<std::unique_ptr<IAction>> actionsToReach;
+	// The node this node was expanded from (nullptr for the initial node).
+	Node* parent = nullptr;
+	// The action that was taken in the parent node to reach this node (default constructed for the initial node).
+	Action action;
 	// The state the search is at in this node.
-	std::unique_ptr<IState> state;
+	State state;
 	// The depth of the node in the tree.
 	int depth;
 	// The cost of the path from the initial state.
 	int pathCost;
 	// The cost of the path from the initial state to the nearest goal state (using heuristics computation).
 	int heuristicCost = -1;
-};
\ No newline at end of file
+	// The position of the node in an indexed open list (-1 when it is not in one).
+	int openIndex = -1;
+	// With the partial-order reduction: whether the successors the reduction skips after the action of the node
+	// have to be generated (see BasicAStarSolver::ReductionState).
+	char reduction = 0;
+
+	Node(State&& state) : state(std::move(state)), depth(0), pathCost(0) {}
+	Node(Node* parent, Action&& action, State&& state, int heuristicCost)
+		: parent(parent), action(std::move(action)), state(std::move(state)),
+		depth(parent->depth + 1), pathCost(parent->pathCost + this->action.Cost()), heuristicCost(heuristicCost) {}
+};
@@ -1,20 +1,35 @@
 #pragma once
-#include "AStarNode.hpp"
 #include "AStarInterface.hpp"
+#include "BasicAStarSolver.hpp"
+#include "InterfaceProblem.hpp"
 #include <vector>
-#include <unordered_set>
 
 // This object is able to solve any search problem, as long as it is implemented following the 
-// IProblem interface.
+// IProblem interface. The search itself is BasicAStarSolver, problems known at compile time can use it directly.
 class AStarSolver 
 {
 public:
+	// The default number of states remembered by the transposition table.
+	static const size_t defaultTranspositionTableLimit = BasicAStarSolver<InterfaceProblem>::defaultTranspositionTableLimit;
+
 	// Solves the problem and returns the sequence of actions to take from the initial state 
 	// to achieve the optimal solution.
 	// Returns the cost of the action chain.
 	// If maxIterations is less than INT32_MAX, it might happen that the solution does not get you to a goal state,
 	// but only to the best state found in the allowed iterations.
 	int Solve(const IProblem& problem, std::vector<std::unique_ptr<IAction>>& solution, int maxIterations = INT32_MAX);
+
+	// Sets the maximum number of states remembered in the transposition table, 0 turns the duplicate detection off.
+	// The table is only used for the problems that support hashing (see IProblem::SupportsHashing).
+	void SetTranspositionTableLimit(size_t limit) { transpositionTableLimit_ = limit; }
+	// Sets the kind of the open list, the binary heap by default.
+	void SetOpenListType(BasicAStarSolver<InterfaceProblem>::OpenListType type) { solver_.SetOpenListType(type); }
+	// Sets whether the successors are built only when they are kept (if the problem supports it), on by default.
+	void SetLazyExpansion(bool lazy) { lazyExpansion_ = lazy; }
+	// Returns the counters of the last search.
+	const AStarStatistics& GetStatistics() const { return solver_.GetStatistics(); }
 private:
-	static Node* MakeNode(Node const* originalNode, IAction* action, IState* state, int heuristicCost);
+	bool lazyExpansion_ = true;
+	size_t transpositionTableLimit_ = defaultTranspositionTableLimit;
+	BasicAStarSolver<InterfaceProblem> solver_;
 };
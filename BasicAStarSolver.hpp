@@ -0,0 +1,1266 @@
+#pragma once
+#include "AStarNode.hpp"
+#include "OpenList.hpp"
+#include "SearchArena.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Counters describing the work done by the last call to Solve.
+struct AStarStatistics
+{
+	// The number of nodes taken from the fringe and expanded.
+	long long expandedNodes = 0;
+	// The number of generated nodes that passed the deepening limit.
+	long long generatedNodes = 0;
+	// The number of successors over the deepening limit (with lazy successors, they are never built).
+	long long prunedSuccessors = 0;
+	// The number of successors dropped because the goal can not be reached from their state.
+	long long deadEndSuccessors = 0;
+	// The number of generated nodes dropped because their state was already reached at the same or lower cost.
+	long long transpositionHits = 0;
+	// The number of generated nodes whose state was not reached before.
+	long long transpositionMisses = 0;
+	// The number of generated nodes whose state was already reached, but at a higher cost.
+	long long reopenedNodes = 0;
+	// The number of reopened states whose node was still in the fringe and was moved to the cheaper path
+	// (only with the indexed heap, the other open lists get a new node).
+	long long decreasedKeys = 0;
+	// The number of fringe nodes skipped, because a cheaper path to their state was found after they were added.
+	long long staleNodes = 0;
+	// The number of expanded nodes whose state was already expanded before, in the same or an earlier deepening iteration.
+	long long reexpandedNodes = 0;
+	// The number of successors skipped by the partial-order reduction.
+	long long reducedSuccessors = 0;
+	// The number of deepening iterations started.
+	int deepeningIterations = 0;
+	// The highest number of bytes the nodes, states and actions of one deepening iteration took from the arena
+	// (of all the iterations, when the fringe is retained).
+	size_t peakArenaBytes = 0;
+};
+
+// The A* search over a problem known at compile time, so that the heuristic and the successor code
+// can be inlined into the search loop. The problem type has to provide:
+//  - StateType, a value type with int Heuristic() const and std::uint64_t Hash() const,
+//  - ActionType, a default constructible value type with int Cost() const,
+//  - const StateType& InitialState() const,
+//  - bool IsGoalState(const StateType& state) const,
+//  - template <typename Visitor> void EnumerateSuccessors(const StateType& state, Visitor& visitor) const,
+//    which calls visitor(successor) for every successor. The successor has to provide int Cost() (of its action),
+//    int Heuristic(), std::uint64_t Hash(), StateType MakeState() and ActionType MakeAction(), and the search
+//    only builds the state and the action of the successors it keeps, each of them at most once
+//    (the partial order reduction builds the action of every successor, right after taking its cost).
+// The states and actions are not destructed when the search releases them, the memory they allocate
+// has to come from SearchArena::AllocateObject (which uses the arena of the search).
+// SolveDepthFirst additionally needs:
+//  - UndoType, the record of what an action changed,
+//  - void ApplyAction(StateType& state, const ActionType& action, UndoType& undo) const,
+//  - void UndoAction(StateType& state, const ActionType& action, const UndoType& undo) const.
+// SetPartialOrderReduction needs bool IsRedundantAfter(const ActionType& previous, const ActionType& action) const,
+// which returns true only if applying the action after previous can be replaced by applying it before previous
+// (which reaches the same state at the same cost), and the action is before previous in a fixed total order.
+// SolveParallel calls InitialState, IsGoalState and EnumerateSuccessors (and builds the states and actions)
+// from several threads at once, so they must be safe to call concurrently.
+template <typename Problem>
+class BasicAStarSolver
+{
+public:
+	using State = typename Problem::StateType;
+	using Action = typename Problem::ActionType;
+	// Receives every improved plan of SolveAnytime, with its cost and the weight of the heuristic it was found with
+	// (the bound of its suboptimality, if the heuristic is admissible).
+	using SolutionCallback = std::function<void(const std::vector<Action>& plan, int cost, double weight)>;
+
+	// The default number of states remembered by the transposition table.
+	static const size_t defaultTranspositionTableLimit = 1 << 22;
+	// The states with this heuristic or a higher one can not reach the goal, the searches drop them
+	// instead of adding them to the fringe.
+	static const int deadEndHeuristic = INT32_MAX / 4;
+
+	// The kinds of the open list the fringe is kept in.
+	enum class OpenListType
+	{
+		// A binary heap, works with any heuristic costs.
+		BINARY_HEAP,
+		// A bucket queue, needs non-negative integer heuristic costs (and is fast for the small ones).
+		BUCKET_QUEUE,
+		// A binary heap that moves the node of a state reached by a cheaper path, instead of adding a new one.
+		INDEXED_HEAP
+	};
+
+	// Solves the problem and returns the sequence of actions to take from the initial state
+	// to achieve the optimal solution.
+	// Returns the cost of the action chain.
+	// If maxIterations is less than INT32_MAX, it might happen that the solution does not get you to a goal state,
+	// but only to the best state found in the allowed iterations.
+	int Solve(const Problem& problem, std::vector<Action>& solution, int maxIterations = INT32_MAX);
+	// Solves the problem by iterative deepening as Solve does, but each deepening iteration is a depth-first search
+	// that applies the actions to a single state in place and takes them back when it backtracks. The memory is linear
+	// in the depth, but the states reached by different paths are searched again (only the states on the current path
+	// are detected). Returns the first plan found within the deepening stop of an iteration: with an admissible
+	// heuristic it is optimal and costs as much as the plan of Solve, with an inadmissible one (as the default
+	// heuristic of LogProblem) it can cost more.
+	// If maxIterations is reached, the path to the state with the lowest heuristic of the last iteration is returned.
+	template <typename P = Problem>
+	int SolveDepthFirst(const P& problem, std::vector<Action>& solution, int maxIterations = INT32_MAX);
+	// Finds a plan quickly with the heuristic multiplied by initialWeight, then searches again with the weight
+	// lowered by weightStep (down to 1), each time only for plans cheaper than the best one so far.
+	// Stops when the search with weight 1 ends or after timeLimit, and returns the cost of the best plan found
+	// (INT32_MAX and no plan if none was found in time). Each improved plan is passed to onSolution as soon as it is found.
+	int SolveAnytime(const Problem& problem, std::vector<Action>& solution, std::chrono::steady_clock::duration timeLimit,
+		const SolutionCallback& onSolution = nullptr, double initialWeight = 5.0, double weightStep = 1.0);
+	// Solves the problem by A* (without the deepening) on threadCount threads (on all the cores if 0), as in HDA*.
+	// Every thread owns its fringe and the transposition table of the states whose hash maps to it, and the nodes
+	// it generates for the states of the other threads are sent to them in batches. The nodes and the successors whose
+	// heuristic cost is not below the cost of the best solution found are dropped, and the search ends when no thread
+	// has a node left and no batch is on its way. So the solution is optimal if the heuristic is admissible (and costs
+	// as much as the one of Solve). With an inadmissible heuristic (as the default one of LogProblem), a cheaper
+	// solution can be dropped by its overestimated cost, and the solution can cost more or less than the one of Solve,
+	// depending on the solution the threads find first.
+	// Returns INT32_MAX and no actions if there is no solution.
+	int SolveParallel(const Problem& problem, std::vector<Action>& solution, unsigned threadCount = 0);
+
+	// Sets the maximum number of states remembered in the transposition table, 0 turns the duplicate detection off.
+	// The table keys the states by their 64-bit hashes alone, without comparing the states, so the states with
+	// the same hash are taken for one state: the hashes of different states must not collide.
+	void SetTranspositionTableLimit(size_t limit) { transpositionTableLimit_ = limit; }
+	// Sets the kind of the open list, the binary heap by default.
+	void SetOpenListType(OpenListType type) { openListType_ = type; }
+	// Sets whether the successors over the deepening stop are kept and resumed by the next deepening iteration
+	// (as in Fringe Search), instead of starting each iteration again from the initial state. Off by default.
+	// The successors are built then, even if the next iteration does not reach them.
+	void SetRetainFringe(bool retain) { retainFringe_ = retain; }
+	// Sets whether the successors by an action that commutes with the action of their parent, and comes before it
+	// in the order of the problem, are skipped (as only one order of the two needs to be searched). The problem has
+	// to provide IsRedundantAfter. Off by default. Used by Solve, SolveAnytime and SolveDepthFirst (not SolveParallel).
+	// As the skipped successors depend on the path, when a state is reached again at the same cost by another action,
+	// the successors skipped from its node are generated after all.
+	void SetPartialOrderReduction(bool reduce) { partialOrderReduction_ = reduce; }
+	// Sets whether the searches print their progress to the standard output, on by default.
+	void SetVerbose(bool verbose) { verbose_ = verbose; }
+	// Returns the counters of the last search.
+	const AStarStatistics& GetStatistics() const { return statistics_; }
+private:
+	using SearchNode = Node<State, Action>;
+
+	// The values of Node::reduction.
+	enum ReductionState : char
+	{
+		// The node was not expanded yet, the reduction can skip some of its successors.
+		REDUCIBLE,
+		// The node was expanded, the reduction could have skipped some of its successors.
+		REDUCED,
+		// All the successors of the node are (or will be) generated.
+		COMPLETE
+	};
+
+	// Runs the search with the fringe kept in the given open list.
+	template <typename OpenList>
+	int Search(const Problem& problem, std::vector<Action>& solution, int maxIterations, OpenList& fringe);
+
+	// Pushes nodes of the successors of an expanded node to the fringe, except for the ones over the deepening limit
+	// and the ones whose state was already reached. Those are never built, unless the successors over the limit
+	// are parked for the next iteration.
+	template <typename OpenList>
+	class SuccessorCollector
+	{
+	public:
+		// With onlyReduced, only the successors the reduction skipped when the parent was expanded are collected.
+		SuccessorCollector(BasicAStarSolver& solver, const Problem& problem, OpenList& fringe, SearchNode* parent,
+			int deepeningStop, int& nextDeepeningStop, bool onlyReduced = false)
+			: solver_(solver), problem_(problem), fringe_(fringe), parent_(parent), deepeningStop_(deepeningStop),
+			nextDeepeningStop_(nextDeepeningStop), onlyReduced_(onlyReduced) {}
+
+		template <typename Successor>
+		void operator()(Successor& successor)
+		{
+			if (!solver_.partialOrderReduction_ || !ProvidesRedundancyTest(problem_, 0))
+			{
+				Collect(successor, nullptr);
+				return;
+			}
+			// The reduction tests the action before the successor is kept, so the action is built once, ahead of the rest.
+			PrebuiltActionSuccessor<Successor> prebuilt(successor);
+			Collect(prebuilt, &prebuilt.GetAction());
+		}
+	private:
+		// Collects the successor, the action is given if the partial order reduction needs to test it.
+		template <typename Successor>
+		void Collect(Successor& successor, const Action* action)
+		{
+			if (action && parent_->parent)
+			{
+				bool redundant = IsRedundantAfter(problem_, parent_->action, *action, 0);
+				if (onlyReduced_ && !redundant)
+					return;
+				if (onlyReduced_)
+				{
+					--solver_.statistics_.reducedSuccessors;
+				}
+				else if (redundant && parent_->reduction != COMPLETE)
+				{
+					++solver_.statistics_.reducedSuccessors;
+					return;
+				}
+			}
+			else if (onlyReduced_)
+			{
+				// Nothing was skipped from the node.
+				return;
+			}
+
+			int pathCost = parent_->pathCost + successor.Cost();
+			if (pathCost >= solver_.costBound_)
+			{
+				++solver_.statistics_.prunedSuccessors;
+				return;
+			}
+			int heuristic = successor.Heuristic();
+			if (heuristic >= deadEndHeuristic)
+			{
+				++solver_.statistics_.deadEndSuccessors;
+				return;
+			}
+			int heuristicCost = pathCost + solver_.WeightHeuristic(heuristic);
+			bool overLimit = heuristicCost > deepeningStop_;
+			if (overLimit)
+			{
+				if (nextDeepeningStop_ > heuristicCost)
+				{
+					nextDeepeningStop_ = heuristicCost;
+				}
+				++solver_.statistics_.prunedSuccessors;
+				if (!solver_.retainFringe_)
+					return;
+			}
+
+			SearchNode** stateNode;
+			if (!solver_.RecordTransposition(successor.Hash(), pathCost, stateNode))
+			{
+				// The node of the state has to generate the successors this path would not skip.
+				if (action && stateNode && *stateNode && !IsSameAction((*stateNode)->action, *action, 0))
+				{
+					solver_.CompleteReduction(*stateNode);
+				}
+				return;
+			}
+
+			if (!overLimit && stateNode && *stateNode && fringe_.contains(*stateNode))
+			{
+				// Only the path to the state changes. The state is replaced too, because the states of the same hash
+				// may differ (by the symmetries of the problem), and the new action leads to the new one.
+				SearchNode* node = *stateNode;
+				node->parent = parent_;
+				node->action = successor.MakeAction();
+				node->state = successor.MakeState();
+				node->depth = parent_->depth + 1;
+				node->pathCost = pathCost;
+				node->heuristicCost = heuristicCost;
+				fringe_.decrease(node);
+				++solver_.statistics_.decreasedKeys;
+				return;
+			}
+
+			SearchNode* node = solver_.arena_.template New<SearchNode>(
+				parent_, successor.MakeAction(), successor.MakeState(), heuristicCost);
+			if (stateNode)
+			{
+				*stateNode = node;
+			}
+			if (overLimit)
+			{
+				solver_.parkedNodes_.push_back(node);
+			}
+			else
+			{
+				fringe_.push(node);
+			}
+			++solver_.statistics_.generatedNodes;
+		}
+
+		BasicAStarSolver& solver_;
+		const Problem& problem_;
+		OpenList& fringe_;
+		SearchNode* parent_;
+		int deepeningStop_;
+		int& nextDeepeningStop_;
+		bool onlyReduced_;
+	};
+
+	// The actions of a state on the path of the depth-first search.
+	template <typename Undo>
+	struct DepthFirstFrame
+	{
+		// The actions that can be taken in the state, the one taken last is at next - 1.
+		std::vector<Action> actions;
+		size_t next;
+		int pathCost;
+		std::uint64_t hash;
+		// What the action taken last changed.
+		Undo undo;
+	};
+
+	// Returns true if the problem provides IsRedundantAfter.
+	template <typename P>
+	static auto ProvidesRedundancyTest(const P& problem, int)
+		-> decltype(problem.IsRedundantAfter(std::declval<const Action&>(), std::declval<const Action&>()), true)
+	{
+		return true;
+	}
+	template <typename P>
+	static bool ProvidesRedundancyTest(const P& /*problem*/, long) { return false; }
+	// Calls the IsRedundantAfter of the problem, returns false if the problem does not provide it.
+	template <typename P>
+	static auto IsRedundantAfter(const P& problem, const Action& previous, const Action& action, int)
+		-> decltype(problem.IsRedundantAfter(previous, action))
+	{
+		return problem.IsRedundantAfter(previous, action);
+	}
+	template <typename P>
+	static bool IsRedundantAfter(const P& /*problem*/, const Action& /*previous*/, const Action& /*action*/, long) { return false; }
+	// Compares the actions, if they can be compared (the actions that cannot are never the same).
+	template <typename A>
+	static auto IsSameAction(const A& first, const A& second, int) -> decltype(first == second) { return first == second; }
+	template <typename A>
+	static bool IsSameAction(const A& /*first*/, const A& /*second*/, long) { return false; }
+
+	// A successor whose action is built ahead of the rest, so that it can be inspected before the successor is kept.
+	// The successors may give their action away only once, and the cost may depend on it, so both are taken first.
+	template <typename Successor>
+	class PrebuiltActionSuccessor
+	{
+	public:
+		PrebuiltActionSuccessor(Successor& successor)
+			: successor_(successor), cost_(successor.Cost()), action_(successor.MakeAction()) {}
+
+		const Action& GetAction() const { return action_; }
+		int Cost() const { return cost_; }
+		int Heuristic() { return successor_.Heuristic(); }
+		std::uint64_t Hash() { return successor_.Hash(); }
+		State MakeState() { return successor_.MakeState(); }
+		Action MakeAction() { return std::move(action_); }
+	private:
+		Successor& successor_;
+		int cost_;
+		Action action_;
+	};
+
+	// Makes the node generate all its successors, because its state was reached by a path of the same cost, whose
+	// successors would be reduced differently. An expanded node is added to the nodes to complete.
+	void CompleteReduction(SearchNode* node)
+	{
+		if (node->reduction == REDUCED)
+		{
+			nodesToComplete_.push_back(node);
+		}
+		node->reduction = COMPLETE;
+	}
+	// Expands the node with the collector, then generates the successors of the nodes to complete.
+	template <typename OpenList>
+	void Expand(const Problem& problem, OpenList& fringe, SearchNode* node, int deepeningStop, int& nextDeepeningStop);
+
+	// Collects the actions of the successors, without building the successors.
+	class ActionCollector
+	{
+	public:
+		ActionCollector(std::vector<Action>& actions) : actions_(actions) {}
+
+		template <typename Successor>
+		void operator()(Successor& successor) { actions_.push_back(successor.MakeAction()); }
+	private:
+		std::vector<Action>& actions_;
+	};
+
+	// Walks the parents of the node and stores copies of the actions leading to it in the solution,
+	// the copies are allocated from the heap.
+	static void BuildSolution(SearchNode const* node, std::vector<Action>& solution);
+
+	// Returns false if the state was already reached with a path cost not higher than pathCost,
+	// otherwise remembers the path cost for the state and returns true. The stateNode is set to the node
+	// remembered for the state, to be updated by the caller (nullptr if the state is not remembered).
+// When false is returned because the state was reached with the same path cost, the stateNode is set too.
+	bool RecordTransposition(std::uint64_t hash, int pathCost, SearchNode**& stateNode);
+
+	// Releases all the nodes, states and actions allocated since the last release.
+	void ReleaseNodes();
+
+	// Returns the heuristic multiplied by the weight, at most deadEndHeuristic (so that adding a path cost does not overflow).
+	int WeightHeuristic(int heuristic) const
+	{
+		if (heuristicWeight_ == 1.0)
+			return heuristic;
+		double weighted = heuristic * heuristicWeight_;
+		return weighted >= deadEndHeuristic ? deadEndHeuristic : (int)weighted;
+	}
+	// The state of one thread of SolveParallel.
+	struct ParallelWorker
+	{
+		BinaryHeapOpenList<SearchNode> fringe;
+		// Maps the hashes of the states owned by the thread to the lowest path cost they were reached with.
+		std::unordered_map<std::uint64_t, int> transpositionTable;
+		// The nodes generated by the thread are allocated from its arena.
+		SearchArena arena;
+		AStarStatistics statistics;
+		// The nodes received from the other threads, in batchCount batches.
+		std::mutex inboxMutex;
+		std::vector<SearchNode*> inbox;
+		size_t batchCount = 0;
+		std::atomic<bool> hasMail{ false };
+		// The nodes to send to the other threads, indexed by the thread.
+		std::vector<std::vector<SearchNode*>> outboxes;
+	};
+
+	// The data shared by the threads of SolveParallel.
+	struct ParallelSearch
+	{
+		const Problem& problem;
+		std::vector<std::unique_ptr<ParallelWorker>> workers;
+		// The cost of the best solution found so far, and its last node.
+		std::atomic<int> bestCost{ INT32_MAX };
+		std::mutex bestNodeMutex;
+		SearchNode* bestNode = nullptr;
+		// The number of the threads that are not idle plus the number of the batches not received yet,
+		// the search ends when it drops to 0 (an idle thread only becomes busy by receiving a batch).
+		std::atomic<long long> pendingWork{ 0 };
+
+		explicit ParallelSearch(const Problem& problem) : problem(problem) {}
+
+		size_t Owner(std::uint64_t hash) const
+		{
+			// The low bits of the hashes are used by the hash tables of the threads.
+			return (size_t)((hash * 0x9E3779B97F4A7C15ull) >> 32) % workers.size();
+		}
+	};
+
+	// Pushes nodes of the successors of a node expanded by a thread of SolveParallel to its fringe
+	// (the ones owned by the thread) or to its outboxes (the others).
+	class ParallelSuccessorCollector
+	{
+	public:
+		ParallelSuccessorCollector(ParallelSearch& search, size_t workerIndex, SearchNode* parent, size_t transpositionTableLimit)
+			: search_(search), workerIndex_(workerIndex), worker_(*search.workers[workerIndex]), parent_(parent),
+			transpositionTableLimit_(transpositionTableLimit) {}
+
+		template <typename Successor>
+		void operator()(Successor& successor)
+		{
+			int pathCost = parent_->pathCost + successor.Cost();
+			int bestCost = search_.bestCost.load(std::memory_order_relaxed);
+			int heuristicCost;
+			if (pathCost >= bestCost || (heuristicCost = pathCost + successor.Heuristic()) >= bestCost)
+			{
+				++worker_.statistics.prunedSuccessors;
+				return;
+			}
+			if (heuristicCost - pathCost >= deadEndHeuristic)
+			{
+				++worker_.statistics.deadEndSuccessors;
+				return;
+			}
+
+			std::uint64_t hash = successor.Hash();
+			size_t owner = search_.Owner(hash);
+			if (owner == workerIndex_ && !RecordTransposition(worker_, hash, pathCost, transpositionTableLimit_))
+				return;
+
+			SearchNode* node = worker_.arena.template New<SearchNode>(
+				parent_, successor.MakeAction(), successor.MakeState(), heuristicCost);
+			if (owner == workerIndex_)
+			{
+				worker_.fringe.push(node);
+			}
+			else
+			{
+				worker_.outboxes[owner].push_back(node);
+			}
+			++worker_.statistics.generatedNodes;
+		}
+	private:
+		ParallelSearch& search_;
+		size_t workerIndex_;
+		ParallelWorker& worker_;
+		SearchNode* parent_;
+		size_t transpositionTableLimit_;
+	};
+
+	// Runs a thread of SolveParallel until the search ends.
+	static void RunParallelWorker(ParallelSearch& search, size_t workerIndex, size_t transpositionTableLimit);
+	// Like RecordTransposition, for the transposition table of a thread of SolveParallel.
+	static bool RecordTransposition(ParallelWorker& worker, std::uint64_t hash, int pathCost, size_t transpositionTableLimit);
+
+	// Runs one best-first search of SolveAnytime (with the current weight and cost bound) and returns the cost
+	// of the plan it found, INT32_MAX if there is none or if the deadline passed (timedOut is set then).
+	int SearchWeighted(const Problem& problem, std::vector<Action>& plan,
+		std::chrono::steady_clock::time_point deadline, bool& timedOut);
+
+	// Returns the standard output if verbose, a stream that drops the output otherwise.
+	std::ostream& Log() const
+	{
+		// Dropping the output changes the state of the stream, so every thread has its own.
+		thread_local std::ostream discard(nullptr);
+		return verbose_ ? std::cout : discard;
+	}
+
+	size_t transpositionTableLimit_ = defaultTranspositionTableLimit;
+	bool retainFringe_ = false;
+	bool partialOrderReduction_ = false;
+	bool verbose_ = true;
+	// The heuristic weight and the bound of the path costs of SolveAnytime (1 and INT32_MAX for the other searches).
+	double heuristicWeight_ = 1.0;
+	int costBound_ = INT32_MAX;
+	OpenListType openListType_ = OpenListType::BINARY_HEAP;
+	BinaryHeapOpenList<SearchNode> binaryHeapOpenList_;
+	BucketOpenList<SearchNode> bucketOpenList_;
+	IndexedHeapOpenList<SearchNode> indexedHeapOpenList_;
+
+	struct Transposition
+	{
+		// The lowest path cost the state was reached with.
+		int pathCost;
+		// The node of the state with that path cost.
+		SearchNode* node;
+	};
+	// Maps the hashes of the reached states to the cheapest path they were reached with.
+	std::unordered_map<std::uint64_t, Transposition> transpositionTable_;
+	AStarStatistics statistics_;
+	// The hashes of the states expanded by the current search.
+	std::unordered_set<std::uint64_t> expandedStates_;
+	// The nodes over the deepening stop, kept for the next iteration if the fringe is retained.
+	std::vector<SearchNode*> parkedNodes_;
+	// The expanded nodes that have to generate the successors the reduction skipped.
+	std::vector<SearchNode*> nodesToComplete_;
+	// The nodes, states and actions of the current deepening iteration are allocated from the arena.
+	SearchArena arena_;
+};
+
+template <typename Problem>
+int BasicAStarSolver<Problem>::Solve(const Problem& problem, std::vector<Action>& solution, int maxIterations)
+{
+	if (openListType_ == OpenListType::BUCKET_QUEUE)
+	{
+		bucketOpenList_.clear();
+		return Search(problem, solution, maxIterations, bucketOpenList_);
+	}
+	if (openListType_ == OpenListType::INDEXED_HEAP)
+	{
+		indexedHeapOpenList_.clear();
+		return Search(problem, solution, maxIterations, indexedHeapOpenList_);
+	}
+	binaryHeapOpenList_.clear();
+	return Search(problem, solution, maxIterations, binaryHeapOpenList_);
+}
+
+template <typename Problem>
+template <typename OpenList>
+int BasicAStarSolver<Problem>::Search(const Problem& problem, std::vector<Action>& solution, int maxIterations,
+	OpenList& fringe)
+{
+	// The states and actions allocated during the search come from the arena.
+	SearchArena::Scope arenaScope(&arena_);
+
+	if (maxIterations == INT32_MAX)
+		Log() << "===========PRECISE SEARCH===========" << std::endl << std::endl;
+	else
+		Log() << "===========LIMITED SEARCH===========" << std::endl << "--iteration limit: " << maxIterations << std::endl << std::endl;
+
+	const State& initialState = problem.InitialState();
+	statistics_ = AStarStatistics();
+
+	int deepeningStop = initialState.Heuristic();
+	int deepeningIteration = 0;
+	SearchNode* currentBestPathNode = nullptr;
+
+	expandedStates_.clear();
+	parkedNodes_.clear();
+
+	// Iterative deepening.
+	while (deepeningIteration < maxIterations)
+	{
+		int nextDeepeningStop = INT32_MAX;
+		++statistics_.deepeningIterations;
+
+		if (!retainFringe_ || deepeningIteration == 0)
+		{
+			// Start with the initial state.
+			SearchNode* initialNode = arena_.template New<SearchNode>(State(initialState));
+			initialNode->heuristicCost = initialState.Heuristic();
+			fringe.push(initialNode);
+
+			// The states reached in the previous iteration will be reached again.
+			transpositionTable_.clear();
+			SearchNode** initialStateNode;
+			RecordTransposition(initialState.Hash(), 0, initialStateNode);
+			if (initialStateNode)
+			{
+				*initialStateNode = initialNode;
+			}
+
+			currentBestPathNode = initialNode;
+		}
+		else
+		{
+			// Resume the parked nodes under the new deepening stop, the others stay parked.
+			size_t parkedCount = 0;
+			for (SearchNode* node : parkedNodes_)
+			{
+				if (node->heuristicCost <= deepeningStop)
+				{
+					fringe.push(node);
+				}
+				else
+				{
+					if (nextDeepeningStop > node->heuristicCost)
+					{
+						nextDeepeningStop = node->heuristicCost;
+					}
+					parkedNodes_[parkedCount++] = node;
+				}
+			}
+			parkedNodes_.resize(parkedCount);
+		}
+
+		// While there are nodes to consider.
+		while (!fringe.empty())
+		{
+			// For each step, expand the best node.
+			SearchNode* bestNode = fringe.pop();
+
+			// Skip the node if its state was reached by a cheaper path after the node was added to the fringe.
+			if (transpositionTableLimit_ > 0 && bestNode->depth > 0)
+			{
+				auto it = transpositionTable_.find(bestNode->state.Hash());
+				if (it != transpositionTable_.end() && it->second.pathCost < bestNode->pathCost)
+				{
+					++statistics_.staleNodes;
+					continue;
+				}
+			}
+
+			// Test for goal state.
+			if (problem.IsGoalState(bestNode->state))
+			{
+				Log() << "Found the solution at iteration number " + std::to_string(deepeningIteration++) + "." << std::endl;
+				Log() << "--expanded nodes: " << statistics_.expandedNodes <<
+					", transposition hits: " << statistics_.transpositionHits <<
+					", misses: " << statistics_.transpositionMisses << std::endl;
+				BuildSolution(bestNode, solution);
+				int pathCost = bestNode->pathCost;
+				// The open list must not keep the nodes of the arena (the indexed heap writes to them when cleared).
+				fringe.clear();
+				parkedNodes_.clear();
+				ReleaseNodes();
+				arena_.Release();
+				return pathCost;
+			}
+
+			if (bestNode->depth != 0)
+			{
+				if (currentBestPathNode->depth == 0 || bestNode->state.Heuristic() <=
+					currentBestPathNode->state.Heuristic())
+				{
+					currentBestPathNode = bestNode;
+				}
+			}
+
+			++statistics_.expandedNodes;
+			if (!expandedStates_.insert(bestNode->state.Hash()).second)
+			{
+				++statistics_.reexpandedNodes;
+			}
+
+			// Enumerate all the states that are reachable (by an action) from the best node state of the fringe.
+			Expand(problem, fringe, bestNode, deepeningStop, nextDeepeningStop);
+		}
+		deepeningStop = nextDeepeningStop;
+		Log() << "Done with iteration number " + std::to_string(deepeningIteration++) + "." << std::endl;
+
+		// With the retained fringe, no parked nodes means that there is nothing more to search,
+		// as does an iteration that left no node over its deepening stop.
+		bool exhausted = (retainFringe_ && parkedNodes_.empty()) || deepeningStop == INT32_MAX;
+
+		// The best path of the last iteration is returned, it has to be saved before its nodes are released.
+		if (deepeningIteration >= maxIterations || exhausted)
+		{
+			BuildSolution(currentBestPathNode, solution);
+		}
+		if (!retainFringe_)
+		{
+			ReleaseNodes();
+		}
+		if (exhausted)
+			break;
+	}
+
+	fringe.clear();
+	parkedNodes_.clear();
+	ReleaseNodes();
+	arena_.Release();
+	return INT32_MAX;
+}
+
+template <typename Problem>
+template <typename OpenList>
+void BasicAStarSolver<Problem>::Expand(const Problem& problem, OpenList& fringe, SearchNode* node, int deepeningStop,
+	int& nextDeepeningStop)
+{
+	SuccessorCollector<OpenList> collector(*this, problem, fringe, node, deepeningStop, nextDeepeningStop);
+	problem.EnumerateSuccessors(node->state, collector);
+	if (node->reduction == REDUCIBLE)
+	{
+		node->reduction = REDUCED;
+	}
+
+	// Completing a node can reach states by paths that make other nodes complete.
+	while (!nodesToComplete_.empty())
+	{
+		SearchNode* nodeToComplete = nodesToComplete_.back();
+		nodesToComplete_.pop_back();
+		SuccessorCollector<OpenList> reducedCollector(*this, problem, fringe, nodeToComplete, deepeningStop,
+			nextDeepeningStop, true);
+		problem.EnumerateSuccessors(nodeToComplete->state, reducedCollector);
+	}
+}
+
+template <typename Problem>
+bool BasicAStarSolver<Problem>::RecordTransposition(std::uint64_t hash, int pathCost, SearchNode**& stateNode)
+{
+	stateNode = nullptr;
+	if (transpositionTableLimit_ == 0)
+		return true;
+
+	auto it = transpositionTable_.find(hash);
+	if (it == transpositionTable_.end())
+	{
+		++statistics_.transpositionMisses;
+		// When the table is full, new states are not remembered, but they are still searched.
+		if (transpositionTable_.size() < transpositionTableLimit_)
+		{
+			stateNode = &transpositionTable_.emplace(hash, Transposition{ pathCost, nullptr }).first->second.node;
+		}
+		return true;
+	}
+	if (it->second.pathCost <= pathCost)
+	{
+		++statistics_.transpositionHits;
+		if (it->second.pathCost == pathCost)
+		{
+			stateNode = &it->second.node;
+		}
+		return false;
+	}
+	// A cheaper path to the state was found, the state needs to be searched again.
+	++statistics_.reopenedNodes;
+	it->second.pathCost = pathCost;
+	stateNode = &it->second.node;
+	return true;
+}
+
+template <typename Problem>
+void BasicAStarSolver<Problem>::BuildSolution(SearchNode const* node, std::vector<Action>& solution)
+{
+	// The solution outlives the search, so the copies must not be allocated from its arena.
+	SearchArena::Scope heap(nullptr);
+	size_t first = solution.size();
+	solution.reserve(first + node->depth);
+	for (; node->parent; node = node->parent)
+	{
+		solution.push_back(node->action);
+	}
+	// The actions were collected from the last one to the first one.
+	std::reverse(solution.begin() + first, solution.end());
+}
+
+template <typename Problem>
+void BasicAStarSolver<Problem>::ReleaseNodes()
+{
+	if (statistics_.peakArenaBytes < arena_.BytesUsed())
+	{
+		statistics_.peakArenaBytes = arena_.BytesUsed();
+	}
+	arena_.Reset();
+}
+
+template <typename Problem>
+template <typename P>
+int BasicAStarSolver<Problem>::SolveDepthFirst(const P& problem, std::vector<Action>& solution, int maxIterations)
+{
+	using Frame = DepthFirstFrame<typename P::UndoType>;
+
+	if (maxIterations == INT32_MAX)
+		Log() << "===========PRECISE DEPTH-FIRST SEARCH===========" << std::endl << std::endl;
+	else
+		Log() << "===========LIMITED DEPTH-FIRST SEARCH===========" << std::endl << "--iteration limit: " << maxIterations << std::endl << std::endl;
+
+	statistics_ = AStarStatistics();
+	// The state the actions are applied to, it is always the state at the end of the current path.
+	State state(problem.InitialState());
+	// The frames are kept between the iterations, so that their memory is reused.
+	std::vector<Frame> frames;
+	std::vector<Action> bestPath;
+
+	if (problem.IsGoalState(state))
+		return 0;
+
+	int deepeningStop = state.Heuristic();
+	int deepeningIteration = 0;
+
+	while (deepeningIteration < maxIterations)
+	{
+		int nextDeepeningStop = INT32_MAX;
+		int bestHeuristic = state.Heuristic();
+		bestPath.clear();
+
+		if (frames.empty())
+		{
+			frames.emplace_back();
+		}
+		size_t depth = 0;
+		frames[0].actions.clear();
+		frames[0].next = 0;
+		frames[0].pathCost = 0;
+		frames[0].hash = state.Hash();
+		ActionCollector rootCollector(frames[0].actions);
+		problem.EnumerateSuccessors(state, rootCollector);
+		++statistics_.expandedNodes;
+
+		for (;;)
+		{
+			Frame& frame = frames[depth];
+			if (frame.next == frame.actions.size())
+			{
+				// All the actions of the state were tried, go back to the previous state.
+				if (depth == 0)
+					break;
+				--depth;
+				Frame& previous = frames[depth];
+				problem.UndoAction(state, previous.actions[previous.next - 1], previous.undo);
+				continue;
+			}
+
+			const Action& action = frame.actions[frame.next++];
+			int pathCost = frame.pathCost + action.Cost();
+			problem.ApplyAction(state, action, frame.undo);
+
+			if (state.Heuristic() >= deadEndHeuristic)
+			{
+				++statistics_.deadEndSuccessors;
+				problem.UndoAction(state, action, frame.undo);
+				continue;
+			}
+			int heuristicCost = pathCost + state.Heuristic();
+			if (heuristicCost > deepeningStop)
+			{
+				if (nextDeepeningStop > heuristicCost)
+				{
+					nextDeepeningStop = heuristicCost;
+				}
+				++statistics_.prunedSuccessors;
+				problem.UndoAction(state, action, frame.undo);
+				continue;
+			}
+
+			// Skip the states that are already on the path, going around a loop never makes the path cheaper.
+			std::uint64_t hash = state.Hash();
+			bool onPath = false;
+			for (size_t i = 0; i <= depth && !onPath; ++i)
+			{
+				onPath = frames[i].hash == hash;
+			}
+			if (onPath)
+			{
+				++statistics_.transpositionHits;
+				problem.UndoAction(state, action, frame.undo);
+				continue;
+			}
+			++statistics_.generatedNodes;
+
+			if (problem.IsGoalState(state))
+			{
+				Log() << "Found the solution at iteration number " + std::to_string(deepeningIteration++) + "." << std::endl;
+				Log() << "--expanded nodes: " << statistics_.expandedNodes << std::endl;
+				for (size_t i = 0; i <= depth; ++i)
+				{
+					solution.push_back(frames[i].actions[frames[i].next - 1]);
+				}
+				return pathCost;
+			}
+
+			if (state.Heuristic() < bestHeuristic)
+			{
+				bestHeuristic = state.Heuristic();
+				bestPath.clear();
+				for (size_t i = 0; i <= depth; ++i)
+				{
+					bestPath.push_back(frames[i].actions[frames[i].next - 1]);
+				}
+			}
+
+			// Go deeper, to the actions of the new state.
+			++depth;
+			if (frames.size() == depth)
+			{
+				frames.emplace_back();
+			}
+			Frame& next = frames[depth];
+			next.actions.clear();
+			next.next = 0;
+			next.pathCost = pathCost;
+			next.hash = hash;
+			ActionCollector collector(next.actions);
+			problem.EnumerateSuccessors(state, collector);
+			++statistics_.expandedNodes;
+			if (partialOrderReduction_)
+			{
+				// The frames could have moved, so the action is taken from them again.
+				const Frame& previous = frames[depth - 1];
+				const Action& previousAction = previous.actions[previous.next - 1];
+				size_t count = next.actions.size();
+				next.actions.erase(std::remove_if(next.actions.begin(), next.actions.end(),
+					[&](const Action& nextAction) { return IsRedundantAfter(problem, previousAction, nextAction, 0); }),
+					next.actions.end());
+				statistics_.reducedSuccessors += count - next.actions.size();
+			}
+		}
+
+		deepeningStop = nextDeepeningStop;
+		Log() << "Done with iteration number " + std::to_string(deepeningIteration++) + "." << std::endl;
+		// Nothing was over the deepening stop, so there is nothing more to search.
+		if (deepeningStop == INT32_MAX)
+			break;
+	}
+
+	solution.insert(solution.end(), bestPath.begin(), bestPath.end());
+	return INT32_MAX;
+}
+
+template <typename Problem>
+int BasicAStarSolver<Problem>::SolveAnytime(const Problem& problem, std::vector<Action>& solution,
+	std::chrono::steady_clock::duration timeLimit, const SolutionCallback& onSolution, double initialWeight, double weightStep)
+{
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeLimit;
+	Log() << "===========ANYTIME SEARCH===========" << std::endl << std::endl;
+
+	statistics_ = AStarStatistics();
+	expandedStates_.clear();
+	costBound_ = INT32_MAX;
+	int bestCost = INT32_MAX;
+	std::vector<Action> plan;
+
+	for (double weight = initialWeight < 1.0 ? 1.0 : initialWeight;; weight = weight - weightStep < 1.0 ? 1.0 : weight - weightStep)
+	{
+		heuristicWeight_ = weight;
+		++statistics_.deepeningIterations;
+
+		bool timedOut = false;
+		plan.clear();
+		int cost = SearchWeighted(problem, plan, deadline, timedOut);
+		if (cost < bestCost)
+		{
+			Log() << "Found a solution of cost " << cost << " with weight " << weight << "." << std::endl;
+			bestCost = cost;
+			costBound_ = cost;
+			solution.swap(plan);
+			if (onSolution)
+			{
+				onSolution(solution, cost, weight);
+			}
+		}
+		if (timedOut)
+		{
+			Log() << "Stopped by the time limit." << std::endl;
+			break;
+		}
+		if (weight == 1.0 || weightStep <= 0.0)
+			break;
+	}
+
+	heuristicWeight_ = 1.0;
+	costBound_ = INT32_MAX;
+	arena_.Release();
+	return bestCost;
+}
+
+template <typename Problem>
+int BasicAStarSolver<Problem>::SearchWeighted(const Problem& problem, std::vector<Action>& plan,
+	std::chrono::steady_clock::time_point deadline, bool& timedOut)
+{
+	// The clock is only read once per this many expanded nodes.
+	const long long deadlineCheckInterval = 64;
+
+	SearchArena::Scope arenaScope(&arena_);
+	BinaryHeapOpenList<SearchNode>& fringe = binaryHeapOpenList_;
+	fringe.clear();
+	parkedNodes_.clear();
+
+	const State& initialState = problem.InitialState();
+	SearchNode* initialNode = arena_.template New<SearchNode>(State(initialState));
+	initialNode->heuristicCost = WeightHeuristic(initialState.Heuristic());
+	fringe.push(initialNode);
+
+	transpositionTable_.clear();
+	SearchNode** initialStateNode;
+	RecordTransposition(initialState.Hash(), 0, initialStateNode);
+	if (initialStateNode)
+	{
+		*initialStateNode = initialNode;
+	}
+
+	int cost = INT32_MAX;
+	// Nothing is over the deepening stop, so it is never lowered.
+	int nextDeepeningStop = INT32_MAX;
+	long long expandedNodes = 0;
+	while (!fringe.empty())
+	{
+		if (++expandedNodes % deadlineCheckInterval == 0 && std::chrono::steady_clock::now() >= deadline)
+		{
+			timedOut = true;
+			break;
+		}
+
+		SearchNode* bestNode = fringe.pop();
+		if (transpositionTableLimit_ > 0 && bestNode->depth > 0)
+		{
+			auto it = transpositionTable_.find(bestNode->state.Hash());
+			if (it != transpositionTable_.end() && it->second.pathCost < bestNode->pathCost)
+			{
+				++statistics_.staleNodes;
+				continue;
+			}
+		}
+		// The cost bound may have been lowered since the node was added.
+		if (bestNode->pathCost >= costBound_)
+			continue;
+
+		if (problem.IsGoalState(bestNode->state))
+		{
+			BuildSolution(bestNode, plan);
+			cost = bestNode->pathCost;
+			break;
+		}
+
+		++statistics_.expandedNodes;
+		if (!expandedStates_.insert(bestNode->state.Hash()).second)
+		{
+			++statistics_.reexpandedNodes;
+		}
+
+		Expand(problem, fringe, bestNode, INT32_MAX, nextDeepeningStop);
+	}
+
+	fringe.clear();
+	ReleaseNodes();
+	return cost;
+}
+
+template <typename Problem>
+int BasicAStarSolver<Problem>::SolveParallel(const Problem& problem, std::vector<Action>& solution, unsigned threadCount)
+{
+	if (threadCount == 0)
+	{
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+	Log() << "===========PARALLEL SEARCH===========" << std::endl << "--threads: " << threadCount << std::endl << std::endl;
+
+	ParallelSearch search(problem);
+	for (unsigned i = 0; i < threadCount; ++i)
+	{
+		search.workers.emplace_back(new ParallelWorker());
+		search.workers.back()->outboxes.resize(threadCount);
+	}
+	// Each thread is busy until it finds its fringe empty for the first time.
+	search.pendingWork = threadCount;
+	// Each thread keeps its share of the states.
+	size_t transpositionTableLimit = transpositionTableLimit_ == 0 ? 0 : std::max<size_t>(1, transpositionTableLimit_ / threadCount);
+
+	const State& initialState = problem.InitialState();
+	ParallelWorker& initialOwner = *search.workers[search.Owner(initialState.Hash())];
+	{
+		SearchArena::Scope arenaScope(&initialOwner.arena);
+		SearchNode* initialNode = initialOwner.arena.template New<SearchNode>(State(initialState));
+		initialNode->heuristicCost = initialState.Heuristic();
+		initialOwner.fringe.push(initialNode);
+		RecordTransposition(initialOwner, initialState.Hash(), 0, transpositionTableLimit);
+	}
+
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < threadCount; ++i)
+	{
+		threads.emplace_back(RunParallelWorker, std::ref(search), i, transpositionTableLimit);
+	}
+	RunParallelWorker(search, 0, transpositionTableLimit);
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	statistics_ = AStarStatistics();
+	statistics_.deepeningIterations = 1;
+	for (const std::unique_ptr<ParallelWorker>& worker : search.workers)
+	{
+		statistics_.expandedNodes += worker->statistics.expandedNodes;
+		statistics_.generatedNodes += worker->statistics.generatedNodes;
+		statistics_.prunedSuccessors += worker->statistics.prunedSuccessors;
+		statistics_.deadEndSuccessors += worker->statistics.deadEndSuccessors;
+		statistics_.transpositionHits += worker->statistics.transpositionHits;
+		statistics_.transpositionMisses += worker->statistics.transpositionMisses;
+		statistics_.reopenedNodes += worker->statistics.reopenedNodes;
+		statistics_.staleNodes += worker->statistics.staleNodes;
+		statistics_.peakArenaBytes += worker->arena.BytesUsed();
+	}
+
+	if (!search.bestNode)
+		return INT32_MAX;
+	Log() << "Found the solution." << std::endl;
+	Log() << "--expanded nodes: " << statistics_.expandedNodes <<
+		", transposition hits: " << statistics_.transpositionHits <<
+		", misses: " << statistics_.transpositionMisses << std::endl;
+	// The nodes of the solution can be in the arenas of all the threads, they are freed with the workers.
+	BuildSolution(search.bestNode, solution);
+	return search.bestNode->pathCost;
+}
+
+template <typename Problem>
+void BasicAStarSolver<Problem>::RunParallelWorker(ParallelSearch& search, size_t workerIndex, size_t transpositionTableLimit)
+{
+	ParallelWorker& worker = *search.workers[workerIndex];
+	SearchArena::Scope arenaScope(&worker.arena);
+	std::vector<SearchNode*> mail;
+	bool busy = true;
+
+	for (;;)
+	{
+		// Take the received nodes, an idle thread becomes busy by the first batch.
+		if (worker.hasMail.load(std::memory_order_acquire))
+		{
+			size_t batchCount;
+			{
+				std::lock_guard<std::mutex> lock(worker.inboxMutex);
+				mail.swap(worker.inbox);
+				batchCount = worker.batchCount;
+				worker.batchCount = 0;
+				worker.hasMail.store(false, std::memory_order_relaxed);
+			}
+			if (batchCount > 0)
+			{
+				search.pendingWork -= busy ? batchCount : batchCount - 1;
+				busy = true;
+			}
+			for (SearchNode* node : mail)
+			{
+				if (RecordTransposition(worker, node->state.Hash(), node->pathCost, transpositionTableLimit))
+				{
+					worker.fringe.push(node);
+				}
+			}
+			mail.clear();
+		}
+
+		// Find the best node that can still lead to a cheaper solution.
+		SearchNode* bestNode = nullptr;
+		while (!worker.fringe.empty())
+		{
+			SearchNode* node = worker.fringe.pop();
+			if (node->heuristicCost >= search.bestCost.load(std::memory_order_relaxed))
+			{
+				// The other nodes are not cheaper.
+				worker.fringe.clear();
+				break;
+			}
+			if (transpositionTableLimit > 0 && node->depth > 0)
+			{
+				auto it = worker.transpositionTable.find(node->state.Hash());
+				if (it != worker.transpositionTable.end() && it->second < node->pathCost)
+				{
+					++worker.statistics.staleNodes;
+					continue;
+				}
+			}
+			bestNode = node;
+			break;
+		}
+
+		if (!bestNode)
+		{
+			if (busy)
+			{
+				busy = false;
+				--search.pendingWork;
+			}
+			if (search.pendingWork.load() == 0)
+				return;
+			std::this_thread::yield();
+			continue;
+		}
+
+		if (search.problem.IsGoalState(bestNode->state))
+		{
+			std::lock_guard<std::mutex> lock(search.bestNodeMutex);
+			if (bestNode->pathCost < search.bestCost.load(std::memory_order_relaxed))
+			{
+				search.bestNode = bestNode;
+				search.bestCost.store(bestNode->pathCost, std::memory_order_relaxed);
+			}
+			continue;
+		}
+
+		++worker.statistics.expandedNodes;
+		ParallelSuccessorCollector collector(search, workerIndex, bestNode, transpositionTableLimit);
+		search.problem.EnumerateSuccessors(bestNode->state, collector);
+
+		// Send the nodes of the other threads, one batch per thread and expansion.
+		for (size_t owner = 0; owner < worker.outboxes.size(); ++owner)
+		{
+			std::vector<SearchNode*>& outbox = worker.outboxes[owner];
+			if (outbox.empty())
+				continue;
+			ParallelWorker& receiver = *search.workers[owner];
+			// The batch is counted before it can be received.
+			++search.pendingWork;
+			{
+				std::lock_guard<std::mutex> lock(receiver.inboxMutex);
+				receiver.inbox.insert(receiver.inbox.end(), outbox.begin(), outbox.end());
+				++receiver.batchCount;
+				receiver.hasMail.store(true, std::memory_order_release);
+			}
+			outbox.clear();
+		}
+	}
+}
+
+template <typename Problem>
+bool BasicAStarSolver<Problem>::RecordTransposition(ParallelWorker& worker, std::uint64_t hash, int pathCost,
+	size_t transpositionTableLimit)
+{
+	if (transpositionTableLimit == 0)
+		return true;
+
+	auto it = worker.transpositionTable.find(hash);
+	if (it == worker.transpositionTable.end())
+	{
+		++worker.statistics.transpositionMisses;
+		if (worker.transpositionTable.size() < transpositionTableLimit)
+		{
+			worker.transpositionTable.emplace(hash, pathCost);
+		}
+		return true;
+	}
+	if (it->second <= pathCost)
+	{
+		++worker.statistics.transpositionHits;
+		return false;
+	}
+	++worker.statistics.reopenedNodes;
+	it->second = pathCost;
+	return true;
+}
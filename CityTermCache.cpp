@@ -0,0 +1,80 @@
+#include "CityTermCache.hpp"
+
+bool CityTermCache::Find(std::uint64_t key, int& term)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto it = index_.find(key);
+	if (it == index_.end())
+	{
+		++misses_;
+		return false;
+	}
+	++hits_;
+	// Move the entry to the front, it is the most recently used one now.
+	entries_.splice(entries_.begin(), entries_, it->second);
+	term = it->second->second;
+	return true;
+}
+
+void CityTermCache::Insert(std::uint64_t key, int term)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (capacity_ == 0)
+		return;
+
+	auto it = index_.find(key);
+	if (it != index_.end())
+	{
+		// Another thread could have computed the same term in the meantime.
+		it->second->second = term;
+		entries_.splice(entries_.begin(), entries_, it->second);
+		return;
+	}
+	entries_.emplace_front(key, term);
+	index_[key] = entries_.begin();
+	Trim();
+}
+
+void CityTermCache::SetCapacity(size_t capacity)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	capacity_ = capacity;
+	Trim();
+}
+
+void CityTermCache::Clear()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	entries_.clear();
+	index_.clear();
+	hits_ = 0;
+	misses_ = 0;
+}
+
+long long CityTermCache::Hits() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return hits_;
+}
+
+long long CityTermCache::Misses() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return misses_;
+}
+
+double CityTermCache::HitRate() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	long long lookups = hits_ + misses_;
+	return lookups > 0 ? (double)hits_ / lookups : 0.;
+}
+
+void CityTermCache::Trim()
+{
+	while (entries_.size() > capacity_)
+	{
+		index_.erase(entries_.back().first);
+		entries_.pop_back();
+	}
+}
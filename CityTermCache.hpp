@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+// A bounded, thread-safe cache of the heuristic ride terms of cities, keyed by the hash of the city-local
+// part of a configuration. When the cache is full, the least recently used term is evicted.
+class CityTermCache
+{
+public:
+	// The default number of cached terms.
+	static const size_t defaultCapacity = 1 << 16;
+
+	CityTermCache(size_t capacity = defaultCapacity) : capacity_(capacity) {}
+
+	// Returns true and sets the term, if a term is cached for the key.
+	bool Find(std::uint64_t key, int& term);
+	// Caches the term for the key.
+	void Insert(std::uint64_t key, int term);
+	// Sets the maximum number of cached terms, 0 turns the cache off.
+	void SetCapacity(size_t capacity);
+	// Forgets all the cached terms and resets the statistics.
+	void Clear();
+
+	size_t Capacity() const { return capacity_; }
+	long long Hits() const;
+	long long Misses() const;
+	// Returns the ratio of successful lookups (0 if there were none).
+	double HitRate() const;
+private:
+	void Trim();
+
+	mutable std::mutex mutex_;
+	size_t capacity_;
+	// The cached terms, the most recently used one first.
+	std::list<std::pair<std::uint64_t, int>> entries_;
+	std::unordered_map<std::uint64_t, std::list<std::pair<std::uint64_t, int>>::iterator> index_;
+	long long hits_ = 0;
+	long long misses_ = 0;
+};
@@ -0,0 +1,179 @@
+#include "DecompositionSolver.hpp"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+// Adds the counters of a search to the sums of the counters.
+static void AddStatistics(AStarStatistics& total, const AStarStatistics& statistics)
+{
+	total.expandedNodes += statistics.expandedNodes;
+	total.generatedNodes += statistics.generatedNodes;
+	total.prunedSuccessors += statistics.prunedSuccessors;
+	total.deadEndSuccessors += statistics.deadEndSuccessors;
+	total.transpositionHits += statistics.transpositionHits;
+	total.transpositionMisses += statistics.transpositionMisses;
+	total.reopenedNodes += statistics.reopenedNodes;
+	total.decreasedKeys += statistics.decreasedKeys;
+	total.staleNodes += statistics.staleNodes;
+	total.reexpandedNodes += statistics.reexpandedNodes;
+	total.reducedSuccessors += statistics.reducedSuccessors;
+	total.deepeningIterations += statistics.deepeningIterations;
+	total.peakArenaBytes = std::max(total.peakArenaBytes, statistics.peakArenaBytes);
+}
+
+int DecompositionSolver::Solve(const LogProblem& problem, std::vector<Action>& solution)
+{
+	std::cout << "===========DECOMPOSED SEARCH===========" << std::endl << std::endl;
+
+	const LogSetting& setting = problem.GetSetting();
+	Span<const Truck> trucks = problem.InitialState().GetTrucksConstReference();
+	Span<const Airplane> airplanes = problem.InitialState().GetAirplanesConstReference();
+	Span<const Package> packages = problem.InitialState().GetPackagesConstReference();
+	const std::vector<int>& airports = setting.GetAirports();
+	int cityCount = setting.CityCount();
+
+	statistics_ = AStarStatistics();
+	subproblemCount_ = 0;
+
+	// The rides in every city before the flights, the flights, and the rides in every city after them.
+	std::vector<Subproblem> departures(cityCount);
+	Subproblem flights;
+	std::vector<Subproblem> arrivals(cityCount);
+
+	for (int truck = 0; truck < trucks.size(); ++truck)
+	{
+		Subproblem& departure = departures[setting.GetPlaceCity(trucks[truck].position)];
+		departure.trucks.push_back(trucks[truck]);
+		departure.vehicleIndices.push_back(truck);
+	}
+	for (int airplane = 0; airplane < airplanes.size(); ++airplane)
+	{
+		flights.airplanes.push_back(airplanes[airplane]);
+		flights.vehicleIndices.push_back(airplane);
+	}
+	for (int package = 0; package < packages.size(); ++package)
+	{
+		const Package& packageObject = packages[package];
+		if (packageObject.state != Package::State::OUT)
+			throw std::runtime_error("The decomposition needs all the packages out of the vehicles!");
+
+		int city = setting.GetPlaceCity(packageObject.position);
+		int destinationCity = setting.GetPlaceCity(packageObject.destination);
+		Package part = packageObject;
+		if (city != destinationCity)
+		{
+			part.destination = airports[city];
+		}
+		departures[city].packages.push_back(part);
+		departures[city].packageIndices.push_back(package);
+
+		if (city != destinationCity)
+		{
+			part.position = airports[city];
+			part.destination = airports[destinationCity];
+			flights.packages.push_back(part);
+			flights.packageIndices.push_back(package);
+
+			part.position = airports[destinationCity];
+			part.destination = packageObject.destination;
+			arrivals[destinationCity].packages.push_back(part);
+			arrivals[destinationCity].packageIndices.push_back(package);
+		}
+	}
+
+	// The last task searches the flights, the others the rides of a city.
+	std::vector<char> solved(cityCount + 1, 0);
+	pool_.ParallelFor(cityCount + 1, [&](size_t task)
+	{
+		if (task == (size_t)cityCount)
+		{
+			solved[task] = SolveSubproblem(setting, flights);
+			return;
+		}
+
+		Subproblem& departure = departures[task];
+		Subproblem& arrival = arrivals[task];
+		if (!SolveSubproblem(setting, departure))
+			return;
+		// The trucks start from where the rides before the flights left them.
+		arrival.trucks = departure.trucks;
+		arrival.vehicleIndices = departure.vehicleIndices;
+		solved[task] = SolveSubproblem(setting, arrival);
+	});
+
+	if (std::find(solved.begin(), solved.end(), 0) != solved.end())
+		return INT32_MAX;
+
+	int cost = 0;
+	auto merge = [&](const Subproblem& subproblem)
+	{
+		solution.insert(solution.end(), subproblem.plan.begin(), subproblem.plan.end());
+		cost += subproblem.cost;
+		if (subproblem.searched)
+		{
+			AddStatistics(statistics_, subproblem.statistics);
+			++subproblemCount_;
+		}
+	};
+	for (const Subproblem& departure : departures)
+	{
+		merge(departure);
+	}
+	merge(flights);
+	for (const Subproblem& arrival : arrivals)
+	{
+		merge(arrival);
+	}
+
+	std::cout << "Found the solution." << std::endl;
+	std::cout << "--subproblems: " << subproblemCount_ <<
+		", expanded nodes: " << statistics_.expandedNodes << std::endl;
+	return cost;
+}
+
+bool DecompositionSolver::SolveSubproblem(const LogSetting& setting, Subproblem& subproblem)
+{
+	bool delivered = std::all_of(subproblem.packages.begin(), subproblem.packages.end(),
+		[](const Package& package) { return package.position == package.destination; });
+	if (delivered)
+		return true;
+	if (subproblem.trucks.empty() && subproblem.airplanes.empty())
+		return false;
+
+	LogProblem problem(setting, subproblem.trucks, subproblem.airplanes, subproblem.packages);
+	BasicAStarSolver<LogProblem> solver;
+	solver.SetVerbose(false);
+	std::vector<Action> plan;
+	subproblem.cost = solver.Solve(problem, plan);
+	subproblem.statistics = solver.GetStatistics();
+	subproblem.searched = true;
+
+	// Leave the vehicles where the plan ends, for the subproblem after this one.
+	LogConfiguration configuration(problem.InitialState());
+	for (const Action& action : plan)
+	{
+		configuration.ApplyAction(action, problem.GetSetting());
+	}
+	if (!problem.IsGoalState(configuration))
+		return false;
+	for (size_t truck = 0; truck < subproblem.trucks.size(); ++truck)
+	{
+		subproblem.trucks[truck].position = configuration.GetTrucksConstReference()[(int)truck].position;
+	}
+	for (size_t airplane = 0; airplane < subproblem.airplanes.size(); ++airplane)
+	{
+		subproblem.airplanes[airplane].position = configuration.GetAirplanesConstReference()[(int)airplane].position;
+	}
+
+	// The actions name the vehicles and the packages by their indices in the subproblem.
+	for (Action& action : plan)
+	{
+		action.valuePair.first = subproblem.vehicleIndices[action.valuePair.first];
+		if (action.type != Action::Type::DRIVE && action.type != Action::Type::FLY)
+		{
+			action.valuePair.second = subproblem.packageIndices[action.valuePair.second];
+		}
+	}
+	subproblem.plan = std::move(plan);
+	return true;
+}
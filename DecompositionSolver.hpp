@@ -0,0 +1,52 @@
+#pragma once
+#include "BasicAStarSolver.hpp"
+#include "LogProblem.hpp"
+#include "ThreadPool.hpp"
+#include <vector>
+
+// Solves a logistics problem by its hierarchy, as many small searches instead of one large one:
+//  - in every city, the trucks bring the packages leaving the city to its airport and deliver the packages
+//    staying in it,
+//  - the airplanes carry the packages leaving their cities from airport to airport,
+//  - in every city, the trucks deliver the packages that came by air from the airport.
+// The subproblems only assume that the others end with the packages at the airports, so all of them run at once
+// on the thread pool (the deliveries from the airport of a city right after the rides to it). The plans are merged
+// in the order above. The merged plan is valid, but usually more expensive than the plan of a search
+// of the whole problem, as the trucks can not carry the packages to and from the airport in one ride.
+// All the packages of the problem must be out of the vehicles.
+class DecompositionSolver
+{
+public:
+	explicit DecompositionSolver(ThreadPool& pool = ThreadPool::Shared()) : pool_(pool) {}
+
+	// Returns the cost of the merged plan, INT32_MAX and no actions if a subproblem has no solution.
+	int Solve(const LogProblem& problem, std::vector<Action>& solution);
+
+	// Returns the sums of the counters of the searches of the subproblems of the last call to Solve.
+	const AStarStatistics& GetStatistics() const { return statistics_; }
+	// Returns the number of the subproblems of the last call to Solve that needed a search.
+	int SubproblemCount() const { return subproblemCount_; }
+private:
+	// A subproblem, with the indices of its vehicles and packages in the whole problem.
+	struct Subproblem
+	{
+		std::vector<Truck> trucks;
+		std::vector<Airplane> airplanes;
+		std::vector<Package> packages;
+		std::vector<int> vehicleIndices;
+		std::vector<int> packageIndices;
+
+		std::vector<Action> plan;
+		int cost = 0;
+		AStarStatistics statistics;
+		bool searched = false;
+	};
+
+	// Searches the subproblem (if any package is not at its destination yet) and maps its plan to the whole problem.
+	// Returns false if it has no solution.
+	static bool SolveSubproblem(const LogSetting& setting, Subproblem& subproblem);
+
+	ThreadPool& pool_;
+	AStarStatistics statistics_;
+	int subproblemCount_ = 0;
+};
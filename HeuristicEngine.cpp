@@ -0,0 +1,411 @@
+#include "HeuristicEngine.hpp"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+// The cost of the facts not reached by the exploration.
+static const int unreached = INT32_MAX;
+
+// The buffers of the evaluations of a thread.
+struct RelaxedExploration
+{
+	std::vector<int> facts;
+	std::vector<int> factCosts;
+	// The operator that reached each fact at its cost, -1 for the facts true in the configuration.
+	std::vector<int> supporters;
+	std::vector<char> closed;
+	// The number of the preconditions of each operator not reached yet.
+	std::vector<int> unsatisfied;
+	// The cost (h_max) or the sum of the costs (h_add) of the reached preconditions of each operator.
+	std::vector<int> operatorValues;
+	std::vector<std::pair<int, int>> queue;
+
+	std::vector<char> marked;
+	std::vector<int> stack;
+
+	// The operator costs LM-cut takes the costs of the landmarks off.
+	std::vector<int> costs;
+	std::vector<int> preconditionChoices;
+	std::vector<char> goalZone;
+	std::vector<char> beforeGoalZone;
+	std::vector<char> inCut;
+	std::vector<int> cut;
+};
+
+thread_local RelaxedExploration relaxedExploration;
+
+// Computes the costs of the facts from the facts of the exploration, h_add if additive, h_max otherwise.
+// If stopAtGoal, stops when the cost of the goal fact is known.
+static void Explore(const RelaxedTask& task, const std::vector<int>& costs, bool additive, bool stopAtGoal,
+	RelaxedExploration& exploration)
+{
+	exploration.factCosts.assign(task.FactCount(), unreached);
+	exploration.supporters.assign(task.FactCount(), -1);
+	exploration.closed.assign(task.FactCount(), 0);
+	exploration.operatorValues.assign(task.OperatorCount(), 0);
+	exploration.unsatisfied.resize(task.OperatorCount());
+	exploration.queue.clear();
+
+	auto reach = [&](int fact, int cost, int supporter)
+	{
+		if (cost < exploration.factCosts[fact])
+		{
+			exploration.factCosts[fact] = cost;
+			exploration.supporters[fact] = supporter;
+			exploration.queue.emplace_back(cost, fact);
+			std::push_heap(exploration.queue.begin(), exploration.queue.end(), std::greater<std::pair<int, int>>());
+		}
+	};
+
+	for (int fact : exploration.facts)
+	{
+		reach(fact, 0, -1);
+	}
+	for (int op = 0; op < task.OperatorCount(); ++op)
+	{
+		exploration.unsatisfied[op] = task.Preconditions(op).size();
+		if (exploration.unsatisfied[op] == 0)
+		{
+			reach(task.Effect(op), costs[op], op);
+		}
+	}
+
+	while (!exploration.queue.empty())
+	{
+		std::pop_heap(exploration.queue.begin(), exploration.queue.end(), std::greater<std::pair<int, int>>());
+		int cost = exploration.queue.back().first;
+		int fact = exploration.queue.back().second;
+		exploration.queue.pop_back();
+		if (exploration.closed[fact])
+			continue;
+		exploration.closed[fact] = 1;
+		if (stopAtGoal && fact == task.GoalFact())
+			return;
+
+		for (int op : task.Triggers(fact))
+		{
+			int& value = exploration.operatorValues[op];
+			value = additive ? value + cost : std::max(value, cost);
+			if (--exploration.unsatisfied[op] == 0)
+			{
+				reach(task.Effect(op), value + costs[op], op);
+			}
+		}
+	}
+}
+
+int HeuristicEngine::Evaluate(Span<const Truck> trucks, Span<const Airplane> airplanes, Span<const Package> packages) const
+{
+	auto start = std::chrono::steady_clock::now();
+	int heuristic = Compute(trucks, airplanes, packages);
+	nanoseconds_ += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	++evaluations_;
+	return heuristic;
+}
+
+double HeuristicEngine::MicrosecondsPerEvaluation() const
+{
+	long long evaluations = evaluations_;
+	return evaluations == 0 ? 0 : nanoseconds_ / 1000.0 / evaluations;
+}
+
+void HeuristicEngine::ResetStatistics()
+{
+	evaluations_ = 0;
+	nanoseconds_ = 0;
+}
+
+std::shared_ptr<HeuristicEngine> HeuristicEngine::Create(const std::string& name, const LogSetting& setting,
+	const LogConfiguration& initial)
+{
+	if (name == "hmax")
+		return std::make_shared<DeleteRelaxationHeuristic>(setting, initial, DeleteRelaxationHeuristic::Kind::MAX);
+	if (name == "hff")
+		return std::make_shared<DeleteRelaxationHeuristic>(setting, initial, DeleteRelaxationHeuristic::Kind::FF);
+	if (name == "lmcut")
+		return std::make_shared<LandmarkCutHeuristic>(setting, initial);
+	throw std::runtime_error("Unknown heuristic engine " + name + "!");
+}
+
+RelaxedTask::RelaxedTask(const LogSetting& setting, const LogConfiguration& initial)
+{
+	Span<const Truck> trucks = initial.GetTrucksConstReference();
+	Span<const Airplane> airplanes = initial.GetAirplanesConstReference();
+	Span<const Package> packages = initial.GetPackagesConstReference();
+
+	placeCount_ = setting.PlaceCount();
+	truckCount_ = trucks.size();
+	airplaneCount_ = airplanes.size();
+	inTruckBase_ = packages.size() * placeCount_;
+	inAirplaneBase_ = inTruckBase_ + packages.size() * truckCount_;
+	truckAtBase_ = inAirplaneBase_ + packages.size() * airplaneCount_;
+	airplaneAtBase_ = truckAtBase_ + truckCount_ * placeCount_;
+	int goalFact = airplaneAtBase_ + airplaneCount_ * placeCount_;
+
+	preconditionStarts_.push_back(0);
+	for (int truck = 0; truck < trucks.size(); ++truck)
+	{
+		Span<const int> places = setting.GetCityPlaces(setting.GetPlaceCity(trucks[truck].position));
+		for (int from : places)
+		{
+			for (int to : places)
+			{
+				if (from != to)
+				{
+					AddOperator(Action::driveCost, TruckAt(truck, to), { TruckAt(truck, from) });
+				}
+			}
+		}
+		for (int package = 0; package < packages.size(); ++package)
+		{
+			for (int place : places)
+			{
+				AddOperator(Action::loadUnloadCost, PackageInTruck(package, truck), { TruckAt(truck, place), PackageAt(package, place) });
+				AddOperator(Action::loadUnloadCost, PackageAt(package, place), { TruckAt(truck, place), PackageInTruck(package, truck) });
+			}
+		}
+	}
+
+	const std::vector<int>& airports = setting.GetAirports();
+	for (int airplane = 0; airplane < airplanes.size(); ++airplane)
+	{
+		for (int from : airports)
+		{
+			for (int to : airports)
+			{
+				if (from != to)
+				{
+					AddOperator(Action::flyCost, AirplaneAt(airplane, to), { AirplaneAt(airplane, from) });
+				}
+			}
+		}
+		for (int package = 0; package < packages.size(); ++package)
+		{
+			for (int airport : airports)
+			{
+				AddOperator(Action::pickUpCost, PackageInAirplane(package, airplane), { AirplaneAt(airplane, airport), PackageAt(package, airport) });
+				AddOperator(Action::dropOffCost, PackageAt(package, airport), { AirplaneAt(airplane, airport), PackageInAirplane(package, airplane) });
+			}
+		}
+	}
+
+	std::vector<int> goals;
+	for (int package = 0; package < packages.size(); ++package)
+	{
+		goals.push_back(PackageAt(package, packages[package].destination));
+	}
+	AddOperator(0, goalFact, goals);
+
+	IndexOperators(goalFact + 1);
+}
+
+void RelaxedTask::AddOperator(int cost, int effect, const std::vector<int>& preconditions)
+{
+	effects_.push_back(effect);
+	costs_.push_back(cost);
+	preconditions_.insert(preconditions_.end(), preconditions.begin(), preconditions.end());
+	preconditionStarts_.push_back((int)preconditions_.size());
+}
+
+void RelaxedTask::IndexOperators(int factCount)
+{
+	triggerStarts_.assign(factCount + 1, 0);
+	achieverStarts_.assign(factCount + 1, 0);
+	for (int op = 0; op < OperatorCount(); ++op)
+	{
+		for (int fact : Preconditions(op))
+		{
+			++triggerStarts_[fact + 1];
+		}
+		++achieverStarts_[effects_[op] + 1];
+	}
+	for (int fact = 0; fact < factCount; ++fact)
+	{
+		triggerStarts_[fact + 1] += triggerStarts_[fact];
+		achieverStarts_[fact + 1] += achieverStarts_[fact];
+	}
+
+	triggers_.resize(triggerStarts_[factCount]);
+	achievers_.resize(achieverStarts_[factCount]);
+	std::vector<int> triggerEnds(triggerStarts_.begin(), triggerStarts_.end() - 1);
+	std::vector<int> achieverEnds(achieverStarts_.begin(), achieverStarts_.end() - 1);
+	for (int op = 0; op < OperatorCount(); ++op)
+	{
+		for (int fact : Preconditions(op))
+		{
+			triggers_[triggerEnds[fact]++] = op;
+		}
+		achievers_[achieverEnds[effects_[op]]++] = op;
+	}
+}
+
+void RelaxedTask::CollectFacts(Span<const Truck> trucks, Span<const Airplane> airplanes, Span<const Package> packages,
+	std::vector<int>& facts) const
+{
+	facts.clear();
+	for (int truck = 0; truck < trucks.size(); ++truck)
+	{
+		facts.push_back(TruckAt(truck, trucks[truck].position));
+	}
+	for (int airplane = 0; airplane < airplanes.size(); ++airplane)
+	{
+		facts.push_back(AirplaneAt(airplane, airplanes[airplane].position));
+	}
+	for (int package = 0; package < packages.size(); ++package)
+	{
+		const Package& packageObject = packages[package];
+		switch (packageObject.state)
+		{
+		case Package::State::OUT:
+			facts.push_back(PackageAt(package, packageObject.position));
+			break;
+		case Package::State::IN_TRUCK:
+			facts.push_back(PackageInTruck(package, packageObject.vehicle));
+			break;
+		case Package::State::IN_PLANE:
+			facts.push_back(PackageInAirplane(package, packageObject.vehicle));
+			break;
+		default:
+			throw std::runtime_error("Undefined package state!");
+		}
+	}
+}
+
+int DeleteRelaxationHeuristic::Compute(Span<const Truck> trucks, Span<const Airplane> airplanes,
+	Span<const Package> packages) const
+{
+	RelaxedExploration& exploration = relaxedExploration;
+	task_.CollectFacts(trucks, airplanes, packages, exploration.facts);
+	Explore(task_, task_.Costs(), kind_ == Kind::FF, true, exploration);
+
+	int goalCost = exploration.factCosts[task_.GoalFact()];
+	if (goalCost == unreached)
+		return deadEnd;
+	if (kind_ == Kind::MAX)
+		return goalCost;
+
+	// The relaxed plan is made of the best supporters of the goal, of their preconditions and so on.
+	int planCost = 0;
+	exploration.marked.assign(task_.OperatorCount(), 0);
+	exploration.stack.assign(1, task_.GoalFact());
+	while (!exploration.stack.empty())
+	{
+		int fact = exploration.stack.back();
+		exploration.stack.pop_back();
+		int op = exploration.supporters[fact];
+		if (op < 0 || exploration.marked[op])
+			continue;
+		exploration.marked[op] = 1;
+		planCost += task_.Cost(op);
+		for (int precondition : task_.Preconditions(op))
+		{
+			exploration.stack.push_back(precondition);
+		}
+	}
+	return planCost;
+}
+
+int LandmarkCutHeuristic::Compute(Span<const Truck> trucks, Span<const Airplane> airplanes,
+	Span<const Package> packages) const
+{
+	RelaxedExploration& exploration = relaxedExploration;
+	task_.CollectFacts(trucks, airplanes, packages, exploration.facts);
+	exploration.costs = task_.Costs();
+	exploration.preconditionChoices.resize(task_.OperatorCount());
+	exploration.inCut.assign(task_.OperatorCount(), 0);
+
+	int heuristic = 0;
+	for (;;)
+	{
+		Explore(task_, exploration.costs, false, false, exploration);
+		int goalCost = exploration.factCosts[task_.GoalFact()];
+		if (goalCost == unreached)
+			return deadEnd;
+		if (goalCost == 0)
+			break;
+
+		// The justification graph has an edge from the most expensive precondition of every reached operator
+		// to its effect.
+		for (int op = 0; op < task_.OperatorCount(); ++op)
+		{
+			int choice = -1;
+			if (exploration.unsatisfied[op] == 0)
+			{
+				for (int precondition : task_.Preconditions(op))
+				{
+					if (choice < 0 || exploration.factCosts[precondition] > exploration.factCosts[choice])
+						choice = precondition;
+				}
+			}
+			exploration.preconditionChoices[op] = choice;
+		}
+
+		// The goal zone are the facts the goal is reached from by the operators of zero cost.
+		exploration.goalZone.assign(task_.FactCount(), 0);
+		exploration.goalZone[task_.GoalFact()] = 1;
+		exploration.stack.assign(1, task_.GoalFact());
+		while (!exploration.stack.empty())
+		{
+			int fact = exploration.stack.back();
+			exploration.stack.pop_back();
+			for (int op : task_.Achievers(fact))
+			{
+				int choice = exploration.preconditionChoices[op];
+				if (exploration.costs[op] == 0 && choice >= 0 && !exploration.goalZone[choice])
+				{
+					exploration.goalZone[choice] = 1;
+					exploration.stack.push_back(choice);
+				}
+			}
+		}
+
+		// The cut are the operators from the facts reached from the configuration without passing the goal zone
+		// into the goal zone.
+		exploration.beforeGoalZone.assign(task_.FactCount(), 0);
+		exploration.stack = exploration.facts;
+		for (int fact : exploration.facts)
+		{
+			exploration.beforeGoalZone[fact] = 1;
+		}
+		exploration.cut.clear();
+		while (!exploration.stack.empty())
+		{
+			int fact = exploration.stack.back();
+			exploration.stack.pop_back();
+			for (int op : task_.Triggers(fact))
+			{
+				if (exploration.preconditionChoices[op] != fact)
+					continue;
+				int effect = task_.Effect(op);
+				if (exploration.goalZone[effect])
+				{
+					if (!exploration.inCut[op])
+					{
+						exploration.inCut[op] = 1;
+						exploration.cut.push_back(op);
+					}
+				}
+				else if (!exploration.beforeGoalZone[effect])
+				{
+					exploration.beforeGoalZone[effect] = 1;
+					exploration.stack.push_back(effect);
+				}
+			}
+		}
+
+		int landmarkCost = unreached;
+		for (int op : exploration.cut)
+		{
+			landmarkCost = std::min(landmarkCost, exploration.costs[op]);
+		}
+		heuristic += landmarkCost;
+		for (int op : exploration.cut)
+		{
+			exploration.costs[op] -= landmarkCost;
+			exploration.inCut[op] = 0;
+		}
+	}
+	return heuristic;
+}
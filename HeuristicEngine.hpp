@@ -0,0 +1,120 @@
+#pragma once
+#include "LogProblem.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// A heuristic computed from the whole configuration, used instead of the incremental heuristic of LogConfiguration
+// (see LogProblem::SetHeuristicEngine). Evaluate counts the evaluations and the time they take, so that the engines
+// can be compared by the cost of an evaluation and the expansions they lead to.
+// The parallel searches evaluate from several threads at once, so the engines must not change on Compute.
+class HeuristicEngine
+{
+public:
+	// The value of the configurations the goal can not be reached from (BasicAStarSolver::deadEndHeuristic).
+	static const int deadEnd = INT32_MAX / 4;
+
+	virtual ~HeuristicEngine() = default;
+
+	int Evaluate(Span<const Truck> trucks, Span<const Airplane> airplanes, Span<const Package> packages) const;
+
+	long long Evaluations() const { return evaluations_; }
+	// Returns the average time of an evaluation (0 if there were none).
+	double MicrosecondsPerEvaluation() const;
+	void ResetStatistics();
+
+	// Creates the engine of the name ("hmax", "hff" or "lmcut") for the setting and the vehicles
+	// of the initial configuration. Throws for an unknown name.
+	static std::shared_ptr<HeuristicEngine> Create(const std::string& name, const LogSetting& setting,
+		const LogConfiguration& initial);
+protected:
+	virtual int Compute(Span<const Truck> trucks, Span<const Airplane> airplanes, Span<const Package> packages) const = 0;
+private:
+	mutable std::atomic<long long> evaluations_{ 0 };
+	mutable std::atomic<long long> nanoseconds_{ 0 };
+};
+
+// The actions of the problem grounded as STRIPS operators without their delete effects (and without the capacities
+// of the vehicles). Every operator has a single effect, an extra operator achieves the goal fact from the packages
+// at their destinations. The trucks never leave their cities, so a truck only gets the operators of the city it starts in.
+class RelaxedTask
+{
+public:
+	RelaxedTask(const LogSetting& setting, const LogConfiguration& initial);
+
+	int FactCount() const { return (int)achieverStarts_.size() - 1; }
+	int OperatorCount() const { return (int)effects_.size(); }
+	int GoalFact() const { return FactCount() - 1; }
+
+	int Effect(int op) const { return effects_[op]; }
+	int Cost(int op) const { return costs_[op]; }
+	const std::vector<int>& Costs() const { return costs_; }
+	Span<const int> Preconditions(int op) const { return Range(preconditions_, preconditionStarts_, op); }
+	// The operators the fact is a precondition of.
+	Span<const int> Triggers(int fact) const { return Range(triggers_, triggerStarts_, fact); }
+	// The operators the fact is the effect of.
+	Span<const int> Achievers(int fact) const { return Range(achievers_, achieverStarts_, fact); }
+
+	// Replaces the facts with the facts true in the configuration.
+	void CollectFacts(Span<const Truck> trucks, Span<const Airplane> airplanes, Span<const Package> packages,
+		std::vector<int>& facts) const;
+private:
+	int PackageAt(int package, int place) const { return package * placeCount_ + place; }
+	int PackageInTruck(int package, int truck) const { return inTruckBase_ + package * truckCount_ + truck; }
+	int PackageInAirplane(int package, int airplane) const { return inAirplaneBase_ + package * airplaneCount_ + airplane; }
+	int TruckAt(int truck, int place) const { return truckAtBase_ + truck * placeCount_ + place; }
+	int AirplaneAt(int airplane, int place) const { return airplaneAtBase_ + airplane * placeCount_ + place; }
+
+	void AddOperator(int cost, int effect, const std::vector<int>& preconditions);
+	// Builds the triggers and the achievers of the facts from the operators.
+	void IndexOperators(int factCount);
+	static Span<const int> Range(const std::vector<int>& items, const std::vector<int>& starts, int index)
+	{
+		return Span<const int>(items.data() + starts[index], starts[index + 1] - starts[index]);
+	}
+
+	int placeCount_, truckCount_, airplaneCount_;
+	int inTruckBase_, inAirplaneBase_, truckAtBase_, airplaneAtBase_;
+
+	std::vector<int> effects_;
+	std::vector<int> costs_;
+	// The ranges of the lists of the operators and the facts in one array each.
+	std::vector<int> preconditionStarts_, preconditions_;
+	std::vector<int> triggerStarts_, triggers_;
+	std::vector<int> achieverStarts_, achievers_;
+};
+
+// The delete-relaxation heuristics: h_max, the cost of the most expensive fact on the way to the goal,
+// and h_FF, the cost of a relaxed plan extracted along the best supporters of h_add.
+class DeleteRelaxationHeuristic : public HeuristicEngine
+{
+public:
+	enum class Kind
+	{
+		MAX,
+		FF
+	};
+
+	DeleteRelaxationHeuristic(const LogSetting& setting, const LogConfiguration& initial, Kind kind)
+		: task_(setting, initial), kind_(kind) {}
+protected:
+	virtual int Compute(Span<const Truck> trucks, Span<const Airplane> airplanes, Span<const Package> packages) const override;
+private:
+	RelaxedTask task_;
+	Kind kind_;
+};
+
+// The LM-cut heuristic: sums the costs of disjunctive action landmarks, found as the cuts in front of the goal
+// of the justification graph of h_max, each time with the costs of the previous landmarks taken off.
+// It is admissible and dominates h_max.
+class LandmarkCutHeuristic : public HeuristicEngine
+{
+public:
+	LandmarkCutHeuristic(const LogSetting& setting, const LogConfiguration& initial) : task_(setting, initial) {}
+protected:
+	virtual int Compute(Span<const Truck> trucks, Span<const Airplane> airplanes, Span<const Package> packages) const override;
+private:
+	RelaxedTask task_;
+};
@@ -0,0 +1,127 @@
+#pragma once
+#include "AStarInterface.hpp"
+#include <memory>
+#include <queue>
+
+// An owning handle of a state of the virtual interface, copying it clones the state.
+class InterfaceState
+{
+public:
+	explicit InterfaceState(IState* state) : state_(state) {}
+	InterfaceState(const InterfaceState& other) : state_(other.state_->Clone()) {}
+	InterfaceState(InterfaceState&& other) noexcept = default;
+	InterfaceState& operator=(InterfaceState&& other) noexcept = default;
+
+	int Heuristic() const { return state_->Heuristic(); }
+	std::uint64_t Hash() const { return state_->Hash(); }
+	IState const* Get() const { return state_.get(); }
+private:
+	std::unique_ptr<IState> state_;
+};
+
+// An owning handle of an action of the virtual interface, copying it clones the action.
+class InterfaceAction
+{
+public:
+	InterfaceAction() {}
+	explicit InterfaceAction(IAction* action) : action_(action) {}
+	InterfaceAction(const InterfaceAction& other) : action_(other.action_ ? other.action_->Clone() : nullptr) {}
+	InterfaceAction(InterfaceAction&& other) noexcept = default;
+	InterfaceAction& operator=(InterfaceAction&& other) noexcept = default;
+
+	int Cost() const { return action_->cost; }
+	// Gives up the ownership of the action.
+	IAction* Release() { return action_.release(); }
+private:
+	std::unique_ptr<IAction> action_;
+};
+
+// Adapts a problem implementing the virtual IProblem interface to BasicAStarSolver.
+class InterfaceProblem
+{
+public:
+	using StateType = InterfaceState;
+	using ActionType = InterfaceAction;
+
+	// If lazyExpansion is set and the problem supports it, the successors are built only when they are kept.
+	InterfaceProblem(const IProblem& problem, bool lazyExpansion)
+		: problem_(problem), initialState_(problem.GetInitialState()->Clone()),
+		lazyExpansion_(lazyExpansion && problem.SupportsLazySuccessors()) {}
+
+	const InterfaceState& InitialState() const { return initialState_; }
+	bool IsGoalState(const InterfaceState& state) const { return problem_.IsGoalState(state.Get()); }
+
+	template <typename Visitor>
+	void EnumerateSuccessors(const InterfaceState& state, Visitor& visitor) const;
+private:
+	// A successor of the virtual interface as seen by BasicAStarSolver.
+	class Successor
+	{
+	public:
+		Successor(ISuccessor& successor) : successor_(successor) {}
+
+		int Cost() const { return successor_.GetAction().cost; }
+		int Heuristic() { return successor_.Heuristic(); }
+		std::uint64_t Hash() { return successor_.Hash(); }
+		InterfaceState MakeState() { return InterfaceState(successor_.MakeState()); }
+		InterfaceAction MakeAction() { return InterfaceAction(successor_.MakeAction()); }
+	private:
+		ISuccessor& successor_;
+	};
+
+	// Passes an already built successor on, the receiver takes the action and the state, if it asks for them.
+	class MaterializedSuccessor : public ISuccessor
+	{
+	public:
+		MaterializedSuccessor(IAction* action, IState* state) : action_(action), state_(state) {}
+
+		virtual IAction const& GetAction() const override { return *action_; }
+		virtual int Heuristic() override { return state_->Heuristic(); }
+		virtual std::uint64_t Hash() override { return state_->Hash(); }
+		virtual IState* MakeState() override { return state_.release(); }
+		virtual IAction* MakeAction() override { return action_.release(); }
+	private:
+		std::unique_ptr<IAction> action_;
+		std::unique_ptr<IState> state_;
+	};
+
+	// Passes the successors of the virtual interface to a BasicAStarSolver visitor.
+	template <typename Visitor>
+	class VisitorBridge : public ISuccessorVisitor
+	{
+	public:
+		VisitorBridge(Visitor& visitor) : visitor_(visitor) {}
+
+		virtual void Visit(ISuccessor& successor) override
+		{
+			Successor adapted(successor);
+			visitor_(adapted);
+		}
+	private:
+		Visitor& visitor_;
+	};
+
+	const IProblem& problem_;
+	InterfaceState initialState_;
+	bool lazyExpansion_;
+};
+
+template <typename Visitor>
+void InterfaceProblem::EnumerateSuccessors(const InterfaceState& state, Visitor& visitor) const
+{
+	VisitorBridge<Visitor> bridge(visitor);
+	if (lazyExpansion_)
+	{
+		problem_.EnumerateSuccessors(state.Get(), bridge);
+		return;
+	}
+
+	std::queue<std::pair<IAction*, IState*>> actions;
+	problem_.EnumeratePossibleActions(state.Get(), actions);
+	while (!actions.empty())
+	{
+		MaterializedSuccessor successor(actions.front().first, actions.front().second);
+		actions.pop();
+		bridge.Visit(successor);
+	}
+}
@@ -1,27 +1,99 @@
 #include "LogProblem.hpp"
+#include "HeuristicEngine.hpp"
 #include "OrientedGraph.hpp"
 #include <fstream>
 #include <string>
 #include <map>
 #include <set>
+#include <cstring>
+#include <type_traits>
+#include <memory>
+#include <algorithm>
 
-//#define OVERCAPACITY_LOG
+// Checks that every incrementally updated heuristic equals the one computed from scratch.
+//#define VERIFY_INCREMENTAL_HEURISTIC
 
-#ifdef OVERCAPACITY_LOG
-#include <iostream>
-#endif
+// Scrambles the bits of the key (the splitmix64 finalizer), so that xor-ing the parts gives a well distributed hash.
+static std::uint64_t MixHash(std::uint64_t key)
+{
+	key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+	return key ^ (key >> 31);
+}
 
 LogProblem::LogProblem(const std::string& file)
-	: setting_(file), initialConfiguration_(
-		std::make_unique<LogConfiguration>(file, setting_)) {}
+	: setting_(file), initialState_(
+		std::make_unique<LogState>(LogConfiguration(file, setting_))) {}
+
+LogProblem::LogProblem(const LogSetting& setting, const std::vector<Truck>& trucks,
+	const std::vector<Airplane>& airplanes, const std::vector<Package>& packages)
+	: setting_(setting), initialState_(
+		std::make_unique<LogState>(LogConfiguration(trucks, airplanes, packages, setting_))) {}
+
+void LogProblem::SetSymmetryReduction(bool reduce)
+{
+	setting_.SetSymmetryReduction(reduce);
+	// The initial configuration was hashed in the previous mode.
+	LogConfiguration configuration(InitialState());
+	configuration.UpdateHash(setting_);
+	initialState_ = std::make_unique<LogState>(std::move(configuration));
+}
+
+void LogProblem::SetHeuristicEngine(std::shared_ptr<const HeuristicEngine> engine)
+{
+	setting_.SetHeuristicEngine(std::move(engine));
+	LogConfiguration configuration(InitialState());
+	configuration.UpdateHeuristic(setting_);
+	initialState_ = std::make_unique<LogState>(std::move(configuration));
+}
+
+bool LogProblem::IsRedundantAfter(const Action& previous, const Action& action) const
+{
+	if (action.type > previous.type || (action.type == previous.type && action.valuePair >= previous.valuePair))
+		return false;
+
+	// The vehicles (the trucks and the airplanes are told apart by the type) and the packages of the actions.
+	auto isTruckAction = [](Action::Type type)
+	{
+		return type == Action::Type::DRIVE || type == Action::Type::LOAD || type == Action::Type::UNLOAD;
+	};
+	auto package = [](const Action& packageAction)
+	{
+		return packageAction.type == Action::Type::DRIVE || packageAction.type == Action::Type::FLY ?
+			-1 : packageAction.valuePair.second;
+	};
+
+	int previousPackage = package(previous);
+	int actionPackage = package(action);
+	if (previousPackage != -1 && previousPackage == actionPackage)
+		return false;
+	if (isTruckAction(previous.type) != isTruckAction(action.type) || previous.valuePair.first != action.valuePair.first)
+		return true;
+
+	// The same vehicle, only the loads and unloads of different packages commute.
+	if (previousPackage == -1 || actionPackage == -1)
+		return false;
+	bool previousUnloads = previous.type == Action::Type::UNLOAD || previous.type == Action::Type::DROP_OFF;
+	bool actionLoads = action.type == Action::Type::LOAD || action.type == Action::Type::PICK_UP;
+	return !(previousUnloads && actionLoads);
+}
 
 void LogProblem::OutputSolution(std::ostream& out, const std::vector<std::unique_ptr<IAction>>& solution)
 {
+	std::vector<Action> actions;
+	actions.reserve(solution.size());
 	for (const std::unique_ptr<IAction>& iAction : solution)
 	{
-		const std::unique_ptr<Action>& action = (const std::unique_ptr<Action>&)iAction;
+		actions.push_back(((LogAction const*)iAction.get())->action);
+	}
+	OutputSolution(out, actions);
+}
 
-		switch (action->type)
+void LogProblem::OutputSolution(std::ostream& out, const std::vector<Action>& solution)
+{
+	for (const Action& action : solution)
+	{
+		switch (action.type)
 		{
 		case Action::Type::DRIVE:
 			out << "drive ";
@@ -46,19 +118,23 @@ void LogProblem::OutputSolution(std::ostream& out, const std::vector<std::unique
 			break;
 		}
 
-		out << action->valuePair.first << ' ' << action->valuePair.second << std::endl;
+		out << action.valuePair.first << ' ' << action.valuePair.second << std::endl;
 	}
 }
 
 IState const* LogProblem::GetInitialState() const
 {
-	return initialConfiguration_.get();
+	return initialState_.get();
 }
 
 bool LogProblem::IsGoalState(IState const* state) const
 {
-	LogConfiguration const* configuration = (LogConfiguration const*) state;
-	for (const auto& package : configuration->GetPackagesConstReference())
+	return IsGoalState(((LogState const*)state)->GetConfiguration());
+}
+
+bool LogProblem::IsGoalState(const LogConfiguration& configuration) const
+{
+	for (const auto& package : configuration.GetPackagesConstReference())
 	{
 		if (package.position != package.destination || package.state != Package::State::OUT)
 			return false;
@@ -67,102 +143,168 @@ bool LogProblem::IsGoalState(IState const* state) const
 	return true;
 }
 
-void LogProblem::EnumeratePossibleActions(IState const* state,
-	std::queue<std::pair<IAction*, IState*>>& possibleActions) const
+// The scratch configuration successors are evaluated in and the id of the successor that was evaluated last.
+// The successors are enumerated one after another, so each thread needs only one.
+thread_local LogConfiguration successorScratch;
+thread_local std::uint64_t successorScratchOwner = 0;
+thread_local std::uint64_t ConfigurationSuccessor::lastId_ = 0;
+
+const LogConfiguration& ConfigurationSuccessor::EvaluateInScratch()
 {
-	LogConfiguration const* configuration = (LogConfiguration const*)state;
-	const std::vector<Vehicle>& trucks = configuration->GetTrucksConstReference();
-	const std::vector<Vehicle>& airplanes = configuration->GetAirplanesConstReference();
-	const std::vector<Package>& packages = configuration->GetPackagesConstReference();
+	if (successorScratchOwner != id_)
+	{
+		// The scratch outlives the searches, its data must not be allocated from their arenas.
+		SearchArena::Scope heap(nullptr);
+		successorScratch = configuration_;
+		successorScratch.ApplyAction(action_, setting_);
+		successorScratchOwner = id_;
+	}
+	return successorScratch;
+}
 
-	// For each truck get all places in the same city and return a configuration of driving.
-	for (int truck = 0; truck < trucks.size(); ++truck)
+void LogProblem::EvaluateSuccessors(const LogConfiguration& configuration, const std::vector<Action>& actions,
+	std::vector<LogConfiguration>& successors) const
+{
+	// The successors are kept by the calling thread to be reused, their data must not be allocated from the arena
+	// of a search (the threads of the pool have none, the calling thread may have one).
+	SearchArena::Scope heap(nullptr);
+	if (successors.size() < actions.size())
 	{
-		const Vehicle& truckObject = trucks[truck];
-		auto placeVector = setting_.GetCityPlaces(setting_.GetPlaceCity(truckObject.position));
-		for (int place : placeVector)
-		{
-			if (place != truckObject.position)
-			{
-				Action* action = new Action(Action::Type::DRIVE, { truck, place });
-				LogConfiguration* state = configuration->GetNewConfiguration(*action, setting_);
-				possibleActions.push({ action, state });
-			}
-		}
+		successors.resize(actions.size());
 	}
 
-	// For all packages that are in trucks or planes, generate an out state.
-	for (int package = 0; package < packages.size(); ++package)
+	auto evaluate = [&](size_t i)
 	{
-		const Package& packageObject = packages[package];
-		if (packageObject.state == Package::State::IN_PLANE)
-		{
-			Action* action = new Action(Action::Type::DROP_OFF, { packageObject.vehicle, package });
-			LogConfiguration* state = configuration->GetNewConfiguration(*action, setting_);
-			possibleActions.push({ action, state });
-		}
-		else if (packageObject.state == Package::State::IN_TRUCK)
+		SearchArena::Scope heap(nullptr);
+		successors[i] = configuration;
+		successors[i].ApplyAction(actions[i], setting_);
+	};
+	if (actions.size() < minParallelSuccessors)
+	{
+		for (size_t i = 0; i < actions.size(); ++i)
 		{
-			Action* action = new Action(Action::Type::UNLOAD, { packageObject.vehicle, package });
-			LogConfiguration* state = configuration->GetNewConfiguration(*action, setting_);
-			possibleActions.push({ action, state });
+			evaluate(i);
 		}
 	}
+	else
+	{
+		evaluationPool_->ParallelFor(actions.size(), evaluate);
+	}
+}
 
-	// For all packages that are in a place, where there is a plane or a truck, create a loaded state.
-	for (int package = 0; package < packages.size(); ++package)
+// A successor of a configuration as a successor of the virtual search interface.
+class LogSuccessor : public ISuccessor
+{
+public:
+	LogSuccessor(ConfigurationSuccessor& successor) : successor_(successor), action_(successor.GetAction()) {}
+
+	virtual IAction const& GetAction() const override { return action_; }
+	virtual int Heuristic() override { return successor_.Heuristic(); }
+	virtual std::uint64_t Hash() override { return successor_.Hash(); }
+	virtual IState* MakeState() override { return new LogState(successor_.MakeState()); }
+	virtual IAction* MakeAction() override { return action_.Clone(); }
+private:
+	ConfigurationSuccessor& successor_;
+	LogAction action_;
+};
+
+void LogProblem::EnumeratePossibleActions(IState const* state,
+	std::queue<std::pair<IAction*, IState*>>& possibleActions) const
+{
+	// Builds every successor.
+	class QueueingVisitor : public ISuccessorVisitor
 	{
-		const Package& packageObject = packages[package];
+	public:
+		QueueingVisitor(std::queue<std::pair<IAction*, IState*>>& possibleActions)
+			: possibleActions_(possibleActions) {}
 
-		if (packageObject.state == Package::State::OUT)
+		virtual void Visit(ISuccessor& successor) override
 		{
-			for (int truck = 0; truck < trucks.size(); ++truck)
-			{
-				if (trucks[truck].position == packageObject.position && trucks[truck].load.size() < truckCapacity)
-				{
-					Action* action = new Action(Action::Type::LOAD, { truck, package });
-					LogConfiguration* state = configuration->GetNewConfiguration(*action, setting_);
-					possibleActions.push({ action, state });
-				}
-#ifdef OVERCAPACITY_LOG
-				else if (trucks[truck].position == packageObject.position)
-				{
-					std::cout << "Over capacity!" << std::endl;
-				}
-#endif
-			}
-
-			for (int airplane = 0; airplane < airplanes.size(); ++airplane)
-			{
-				if (airplanes[airplane].position == packageObject.position && airplanes[airplane].load.size() < planeCapacity)
-				{
-					Action* action = new Action(Action::Type::PICK_UP, { airplane, package });
-					LogConfiguration* state = configuration->GetNewConfiguration(*action, setting_);
-					possibleActions.push({ action, state });
-				}
-			}
+			possibleActions_.push({ successor.MakeAction(), successor.MakeState() });
 		}
-	}
+	private:
+		std::queue<std::pair<IAction*, IState*>>& possibleActions_;
+	} visitor(possibleActions);
 
-	const std::vector<int>& airports = setting_.GetAirports();
+	EnumerateSuccessors(state, visitor);
+}
 
-	// For all planes create a flight to every other city.
-	for (int airplane = 0; airplane < airplanes.size(); ++airplane)
+void LogProblem::EnumerateSuccessors(IState const* state, ISuccessorVisitor& visitor) const
+{
+	// Passes the successors on as successors of the virtual interface.
+	class BridgingVisitor
 	{
-		const Vehicle& airplaneObject = airplanes[airplane];
+	public:
+		BridgingVisitor(ISuccessorVisitor& visitor) : visitor_(visitor) {}
 
-		for (int airport : airports)
+		void operator()(ConfigurationSuccessor& successor)
 		{
-			if (airport != airplaneObject.position)
-			{
-				Action* action = new Action(Action::Type::FLY, { airplane, airport });
-				LogConfiguration* state = configuration->GetNewConfiguration(*action, setting_);
-				possibleActions.push({ action, state });
-			}
+			LogSuccessor logSuccessor(successor);
+			visitor_.Visit(logSuccessor);
 		}
+	private:
+		ISuccessorVisitor& visitor_;
+	} bridge(visitor);
+
+	EnumerateSuccessors(((LogState const*)state)->GetConfiguration(), bridge);
+}
+
+void Occupancy::Build(Span<const Truck> trucks, Span<const Airplane> airplanes, Span<const Package> packages,
+	const LogSetting& setting)
+{
+	int placeCount = setting.PlaceCount();
+	std::fill(firstTrucks_, firstTrucks_ + placeCount, -1);
+	std::fill(firstAirplanes_, firstAirplanes_ + placeCount, -1);
+	std::fill(placePackageCounts_, placePackageCounts_ + placeCount, 0);
+	std::fill(cityPackageCounts_, cityPackageCounts_ + setting.CityCount(), 0);
+
+	// The vehicles are prepended from the last one, so that the lists come out sorted.
+	for (int truck = trucks.size() - 1; truck >= 0; --truck)
+	{
+		nextTrucks_[truck] = firstTrucks_[trucks[truck].position];
+		firstTrucks_[trucks[truck].position] = truck;
+	}
+	for (int airplane = airplanes.size() - 1; airplane >= 0; --airplane)
+	{
+		nextAirplanes_[airplane] = firstAirplanes_[airplanes[airplane].position];
+		firstAirplanes_[airplanes[airplane].position] = airplane;
+	}
+	for (const Package& package : packages)
+	{
+		++placePackageCounts_[package.position];
+		++cityPackageCounts_[setting.GetPlaceCity(package.position)];
 	}
 }
 
+void Occupancy::MovePackages(int count, int from, int to, const LogSetting& setting)
+{
+	placePackageCounts_[from] -= count;
+	placePackageCounts_[to] += count;
+	cityPackageCounts_[setting.GetPlaceCity(from)] -= count;
+	cityPackageCounts_[setting.GetPlaceCity(to)] += count;
+}
+
+void Occupancy::Link(int* first, int* next, int vehicle, int place)
+{
+	int* link = first + place;
+	while (*link >= 0 && *link < vehicle)
+	{
+		link = next + *link;
+	}
+	next[vehicle] = *link;
+	*link = vehicle;
+}
+
+void Occupancy::Unlink(int* first, int* next, int vehicle, int place)
+{
+	int* link = first + place;
+	while (*link != vehicle)
+	{
+		link = next + *link;
+	}
+	*link = next[vehicle];
+}
+
 int LogConfiguration::TruckRideCheck(int location, int destination, Package::State packageState)
 {
 	int cumulativeCost = 0;
@@ -183,259 +325,707 @@ int LogConfiguration::TruckRideCheck(int location, int destination, Package::Sta
 
 LogConfiguration::LogConfiguration(const std::string& file, const LogSetting& setting)
 {
-	heuristic = LoadConfiguration(file, setting);
+	heuristic_ = LoadConfiguration(file, setting);
+}
+
+LogConfiguration::LogConfiguration(const std::vector<Truck>& trucks, const std::vector<Airplane>& airplanes,
+	const std::vector<Package>& packages, const LogSetting& setting)
+{
+	InitializeObjects(trucks, airplanes, packages, setting);
+}
+
+LogConfiguration::LogConfiguration(const LogConfiguration& other)
+{
+	AllocateData(other.truckCount_, other.airplaneCount_, other.packageCount_, other.cityCount_, other.placeCount_);
+	memcpy(data_.get(), other.data_.get(), DataSize());
+	transferCostSum_ = other.transferCostSum_;
+	rideTermSum_ = other.rideTermSum_;
+	flightTerm_ = other.flightTerm_;
+	heuristic_ = other.heuristic_;
+	hash_ = other.hash_;
+}
+
+LogConfiguration& LogConfiguration::operator=(const LogConfiguration& other)
+{
+	if (this == &other)
+		return *this;
+
+	if (!data_ || DataSize() != other.DataSize())
+	{
+		AllocateData(other.truckCount_, other.airplaneCount_, other.packageCount_, other.cityCount_, other.placeCount_);
+	}
+	else
+	{
+		truckCount_ = other.truckCount_;
+		airplaneCount_ = other.airplaneCount_;
+		packageCount_ = other.packageCount_;
+		cityCount_ = other.cityCount_;
+		placeCount_ = other.placeCount_;
+	}
+	memcpy(data_.get(), other.data_.get(), DataSize());
+	transferCostSum_ = other.transferCostSum_;
+	rideTermSum_ = other.rideTermSum_;
+	flightTerm_ = other.flightTerm_;
+	heuristic_ = other.heuristic_;
+	hash_ = other.hash_;
+	return *this;
+}
+
+size_t LogConfiguration::DataSize() const
+{
+	return truckCount_ * sizeof(Truck) + airplaneCount_ * sizeof(Airplane) + packageCount_ * sizeof(Package) +
+		(cityCount_ + Occupancy::IndexSize(placeCount_, truckCount_, airplaneCount_, cityCount_)) * sizeof(int);
 }
 
-LogConfiguration::LogConfiguration(std::vector<Vehicle>& trucks, std::vector<Vehicle>& airplanes,
-	std::vector<Package>& packages, int heuristic)
+void LogConfiguration::AllocateData(int truckCount, int airplaneCount, int packageCount, int cityCount, int placeCount)
 {
-	std::swap(trucks_, trucks);
-	std::swap(airplanes_, airplanes);
-	std::swap(packages_, packages);
-	IState::heuristic = heuristic;
+	static_assert(std::is_trivially_copyable<Truck>::value &&
+		std::is_trivially_copyable<Airplane>::value &&
+		std::is_trivially_copyable<Package>::value, "The configuration is copied with memcpy.");
+
+	truckCount_ = truckCount;
+	airplaneCount_ = airplaneCount;
+	packageCount_ = packageCount;
+	cityCount_ = cityCount;
+	placeCount_ = placeCount;
+	data_.reset((unsigned char*)SearchArena::AllocateObject(DataSize()));
 }
 
-LogConfiguration* LogConfiguration::GetNewConfiguration(const Action& action,
+LogConfiguration LogConfiguration::GetNewConfiguration(const Action& action,
 	const LogSetting& setting) const
 {
-	std::vector<Vehicle> trucks;
-	std::vector<Vehicle> airplanes;
-	std::vector<Package> packages;
+	LogConfiguration result(*this);
+	result.ApplyAction(action, setting);
+	return result;
+}
+
+void LogConfiguration::ApplyAction(const Action& action, const LogSetting& setting)
+{
+	ApplyAction(action, setting, nullptr);
+}
+
+void LogConfiguration::ApplyAction(const Action& action, const LogSetting& setting, Undo& undo)
+{
+	ApplyAction(action, setting, &undo);
+}
+
+void LogConfiguration::ApplyAction(const Action& action, const LogSetting& setting, Undo* undo)
+{
+	if (undo)
+	{
+		SaveUndo(action, *undo);
+	}
+
+	Span<Truck> trucks = GetTrucksReference();
+	Span<Airplane> airplanes = GetAirplanesReference();
+	Span<Package> packages = GetPackagesReference();
+	Occupancy occupancy = GetOccupancy();
 
-	trucks = trucks_;
-	airplanes = airplanes_;
-	packages = packages_;
+	// The cities whose ride terms need to be computed again.
+	int dirtyCities[Airplane::capacity + 2];
+	int dirtyCityCount = 0;
+	auto markCityDirty = [&](int city)
+	{
+		for (int i = 0; i < dirtyCityCount; ++i)
+		{
+			if (dirtyCities[i] == city)
+				return;
+		}
+		dirtyCities[dirtyCityCount++] = city;
+	};
+	bool flightTermDirty = false;
 
 	switch (action.type)
 	{
 	case Action::Type::DRIVE:
-		trucks[action.valuePair.first].position = action.valuePair.second;
+	{
+		Truck& truck = trucks[action.valuePair.first];
+		markCityDirty(setting.GetPlaceCity(truck.position));
+
+		DetachTruck(action.valuePair.first, setting);
+		occupancy.MoveTruck(action.valuePair.first, truck.position, action.valuePair.second);
+		occupancy.MovePackages(truck.load.size(), truck.position, action.valuePair.second, setting);
+		truck.position = action.valuePair.second;
+		AttachTruck(action.valuePair.first, setting);
 
-		for (auto it = trucks[action.valuePair.first].load.begin();
-			it != trucks[action.valuePair.first].load.end();
-			++it)
+		for (int package : truck.load)
 		{
-			packages[*it].position = action.valuePair.second;
+			DetachPackage(package, setting);
+			packages[package].position = action.valuePair.second;
+			AttachPackage(package, setting);
+			// The package may have moved to or from the airport, which changes the places to visit in the destination city.
+			markCityDirty(setting.GetPlaceCity(packages[package].destination));
 		}
 
 		break;
+	}
 	case Action::Type::LOAD:
+		DetachPackage(action.valuePair.second, setting);
+		DetachTruck(action.valuePair.first, setting);
 		trucks[action.valuePair.first].load.insert(action.valuePair.second);
 		packages[action.valuePair.second].state = Package::State::IN_TRUCK;
 		packages[action.valuePair.second].vehicle = action.valuePair.first;
+		AttachTruck(action.valuePair.first, setting);
+		AttachPackage(action.valuePair.second, setting);
 		break;
 	case Action::Type::UNLOAD:
+		DetachPackage(action.valuePair.second, setting);
+		DetachTruck(action.valuePair.first, setting);
 		trucks[action.valuePair.first].load.erase(action.valuePair.second);
 		packages[action.valuePair.second].state = Package::State::OUT;
 		packages[action.valuePair.second].vehicle = -1;
+		AttachTruck(action.valuePair.first, setting);
+		AttachPackage(action.valuePair.second, setting);
 		break;
 	case Action::Type::FLY:
-		airplanes[action.valuePair.first].position = action.valuePair.second;
-
-		for (auto it = airplanes[action.valuePair.first].load.begin();
-			it != airplanes[action.valuePair.first].load.end();
-			++it)
+	{
+		Airplane& airplane = airplanes[action.valuePair.first];
+		markCityDirty(setting.GetPlaceCity(airplane.position));
+		markCityDirty(setting.GetPlaceCity(action.valuePair.second));
+		flightTermDirty = true;
+
+		DetachAirplane(action.valuePair.first, setting);
+		occupancy.MoveAirplane(action.valuePair.first, airplane.position, action.valuePair.second);
+		occupancy.MovePackages(airplane.load.size(), airplane.position, action.valuePair.second, setting);
+		airplane.position = action.valuePair.second;
+		AttachAirplane(action.valuePair.first, setting);
+
+		for (int package : airplane.load)
 		{
-			packages[*it].position = action.valuePair.second;
+			DetachPackage(package, setting);
+			packages[package].position = action.valuePair.second;
+			AttachPackage(package, setting);
+			markCityDirty(setting.GetPlaceCity(packages[package].destination));
 		}
 
 		break;
+	}
 	case Action::Type::PICK_UP:
+		DetachPackage(action.valuePair.second, setting);
+		DetachAirplane(action.valuePair.first, setting);
 		airplanes[action.valuePair.first].load.insert(action.valuePair.second);
 		packages[action.valuePair.second].state = Package::State::IN_PLANE;
 		packages[action.valuePair.second].vehicle = action.valuePair.first;
+		AttachAirplane(action.valuePair.first, setting);
+		AttachPackage(action.valuePair.second, setting);
 		break;
 	case Action::Type::DROP_OFF:
+		DetachPackage(action.valuePair.second, setting);
+		DetachAirplane(action.valuePair.first, setting);
 		airplanes[action.valuePair.first].load.erase(action.valuePair.second);
 		packages[action.valuePair.second].state = Package::State::OUT;
 		packages[action.valuePair.second].vehicle = -1;
+		AttachAirplane(action.valuePair.first, setting);
+		AttachPackage(action.valuePair.second, setting);
+		break;
+	default:
+		throw std::runtime_error("Undefined action value!");
+		break;
+	}
+
+	// The engine computes everything.
+	if (setting.GetHeuristicEngine())
+	{
+		dirtyCityCount = 0;
+		flightTermDirty = false;
+	}
+
+	// Loading and unloading does not move anything, so only the transfer costs change.
+	for (int i = 0; i < dirtyCityCount; ++i)
+	{
+		int city = dirtyCities[i];
+		if (undo)
+		{
+			undo->cities[undo->cityCount] = city;
+			undo->cityRideTerms[undo->cityCount++] = CityRideTerms()[city];
+		}
+		int cityRideTerm = LookupCityRideTerm(city, packages, occupancy, setting);
+		rideTermSum_ += cityRideTerm - CityRideTerms()[city];
+		CityRideTerms()[city] = cityRideTerm;
+	}
+	if (flightTermDirty)
+	{
+		flightTerm_ = ComputeFlightTerm(airplanes, packages, occupancy, setting);
+	}
+
+	if (setting.GetHeuristicEngine())
+		heuristic_ = setting.GetHeuristicEngine()->Evaluate(trucks, airplanes, packages);
+	else
+		heuristic_ = CombineHeuristicTerms(transferCostSum_, rideTermSum_, flightTerm_);
+
+#ifdef VERIFY_INCREMENTAL_HEURISTIC
+	if (heuristic_ != ComputeHeuristic(trucks, airplanes, packages, setting))
+		throw std::runtime_error("The incremental heuristic differs from the full computation!");
+#endif
+}
+
+void LogConfiguration::SaveUndo(const Action& action, Undo& undo) const
+{
+	undo.hash = hash_;
+	undo.heuristic = heuristic_;
+	undo.transferCostSum = transferCostSum_;
+	undo.rideTermSum = rideTermSum_;
+	undo.flightTerm = flightTerm_;
+	undo.packageCount = 0;
+	undo.cityCount = 0;
+
+	auto savePackage = [&](int package)
+	{
+		undo.packages[undo.packageCount] = package;
+		undo.packageValues[undo.packageCount++] = Packages()[package];
+	};
+
+	switch (action.type)
+	{
+	case Action::Type::DRIVE:
+		undo.truck = Trucks()[action.valuePair.first];
+		for (int package : undo.truck.load)
+		{
+			savePackage(package);
+		}
+		break;
+	case Action::Type::LOAD:
+	case Action::Type::UNLOAD:
+		undo.truck = Trucks()[action.valuePair.first];
+		savePackage(action.valuePair.second);
+		break;
+	case Action::Type::FLY:
+		undo.airplane = Airplanes()[action.valuePair.first];
+		for (int package : undo.airplane.load)
+		{
+			savePackage(package);
+		}
+		break;
+	case Action::Type::PICK_UP:
+	case Action::Type::DROP_OFF:
+		undo.airplane = Airplanes()[action.valuePair.first];
+		savePackage(action.valuePair.second);
 		break;
 	default:
 		throw std::runtime_error("Undefined action value!");
 		break;
 	}
+}
+
+void LogConfiguration::UndoAction(const Action& action, const LogSetting& setting, const Undo& undo)
+{
+	// Only the moves change the occupancy, the vehicle is moved back before it is restored.
+	Occupancy occupancy = GetOccupancy();
+	if (action.type == Action::Type::DRIVE)
+	{
+		const Truck& truck = Trucks()[action.valuePair.first];
+		occupancy.MoveTruck(action.valuePair.first, truck.position, undo.truck.position);
+		occupancy.MovePackages(truck.load.size(), truck.position, undo.truck.position, setting);
+	}
+	else if (action.type == Action::Type::FLY)
+	{
+		const Airplane& airplane = Airplanes()[action.valuePair.first];
+		occupancy.MoveAirplane(action.valuePair.first, airplane.position, undo.airplane.position);
+		occupancy.MovePackages(airplane.load.size(), airplane.position, undo.airplane.position, setting);
+	}
+
+	switch (action.type)
+	{
+	case Action::Type::DRIVE:
+	case Action::Type::LOAD:
+	case Action::Type::UNLOAD:
+		Trucks()[action.valuePair.first] = undo.truck;
+		break;
+	default:
+		Airplanes()[action.valuePair.first] = undo.airplane;
+		break;
+	}
+	for (int i = 0; i < undo.packageCount; ++i)
+	{
+		Packages()[undo.packages[i]] = undo.packageValues[i];
+	}
+	for (int i = 0; i < undo.cityCount; ++i)
+	{
+		CityRideTerms()[undo.cities[i]] = undo.cityRideTerms[i];
+	}
+
+	hash_ = undo.hash;
+	heuristic_ = undo.heuristic;
+	transferCostSum_ = undo.transferCostSum;
+	rideTermSum_ = undo.rideTermSum;
+	flightTerm_ = undo.flightTerm;
+}
+
+void LogConfiguration::DetachPackage(int package, const LogSetting& setting)
+{
+	const Package& packageObject = Packages()[package];
+	if (setting.SymmetryReduction())
+		hash_ -= SymmetricHashPackage(packageObject);
+	else
+		hash_ ^= HashPackage(package, packageObject);
+	transferCostSum_ -= ComputeTransferCost(packageObject, setting);
+}
+
+void LogConfiguration::AttachPackage(int package, const LogSetting& setting)
+{
+	const Package& packageObject = Packages()[package];
+	if (setting.SymmetryReduction())
+		hash_ += SymmetricHashPackage(packageObject);
+	else
+		hash_ ^= HashPackage(package, packageObject);
+	transferCostSum_ += ComputeTransferCost(packageObject, setting);
+}
+
+void LogConfiguration::DetachTruck(int truck, const LogSetting& setting)
+{
+	if (setting.SymmetryReduction())
+		hash_ -= SymmetricHashVehicle(1, Trucks()[truck], GetPackagesConstReference());
+	else
+		hash_ ^= HashTruck(truck, Trucks()[truck]);
+}
+
+void LogConfiguration::AttachTruck(int truck, const LogSetting& setting)
+{
+	if (setting.SymmetryReduction())
+		hash_ += SymmetricHashVehicle(1, Trucks()[truck], GetPackagesConstReference());
+	else
+		hash_ ^= HashTruck(truck, Trucks()[truck]);
+}
+
+void LogConfiguration::DetachAirplane(int airplane, const LogSetting& setting)
+{
+	if (setting.SymmetryReduction())
+		hash_ -= SymmetricHashVehicle(2, Airplanes()[airplane], GetPackagesConstReference());
+	else
+		hash_ ^= HashAirplane(airplane, Airplanes()[airplane]);
+}
+
+void LogConfiguration::AttachAirplane(int airplane, const LogSetting& setting)
+{
+	if (setting.SymmetryReduction())
+		hash_ += SymmetricHashVehicle(2, Airplanes()[airplane], GetPackagesConstReference());
+	else
+		hash_ ^= HashAirplane(airplane, Airplanes()[airplane]);
+}
+
+void LogConfiguration::InitializeHeuristicTerms(const LogSetting& setting)
+{
+	Span<const Truck> trucks = GetTrucksConstReference();
+	Span<const Airplane> airplanes = GetAirplanesConstReference();
+	Span<const Package> packages = GetPackagesConstReference();
+
+	transferCostSum_ = 0;
+	for (const Package& package : packages)
+	{
+		transferCostSum_ += ComputeTransferCost(package, setting);
+	}
+
+	rideTermSum_ = 0;
+	flightTerm_ = 0;
+	if (setting.GetHeuristicEngine())
+	{
+		std::fill(CityRideTerms(), CityRideTerms() + cityCount_, 0);
+	}
+	else
+	{
+		for (int city = 0; city < cityCount_; ++city)
+		{
+			CityRideTerms()[city] = LookupCityRideTerm(city, packages, GetOccupancy(), setting);
+			rideTermSum_ += CityRideTerms()[city];
+		}
+
+		flightTerm_ = ComputeFlightTerm(airplanes, packages, GetOccupancy(), setting);
+	}
 
-	int heuristic = ComputeHeuristic(trucks, airplanes, packages, setting);
-	return new LogConfiguration(trucks, airplanes, packages, heuristic);
+	if (setting.GetHeuristicEngine())
+		heuristic_ = setting.GetHeuristicEngine()->Evaluate(trucks, airplanes, packages);
+	else
+		heuristic_ = CombineHeuristicTerms(transferCostSum_, rideTermSum_, flightTerm_);
 }
 
-int LogConfiguration::ComputeHeuristic(const std::vector<Vehicle>& trucks,
-	const std::vector<Vehicle>& airplanes,
-	const std::vector<Package>& packages,
+int LogConfiguration::ComputeHeuristic(Span<const Truck> trucks,
+	Span<const Airplane> airplanes,
+	Span<const Package> packages,
 	const LogSetting& setting)
+{
+	if (setting.GetHeuristicEngine())
+		return setting.GetHeuristicEngine()->Evaluate(trucks, airplanes, packages);
+
+	int transferCostSum = 0;
+	for (const Package& package : packages)
+	{
+		transferCostSum += ComputeTransferCost(package, setting);
+	}
+
+	// The spans are not a part of a configuration, so they are indexed here.
+	thread_local std::vector<int> index;
+	index.resize(Occupancy::IndexSize(setting.PlaceCount(), trucks.size(), airplanes.size(), setting.CityCount()));
+	Occupancy occupancy(index.data(), setting.PlaceCount(), trucks.size(), airplanes.size());
+	occupancy.Build(trucks, airplanes, packages, setting);
+
+	int rideTermSum = 0;
+	for (int city = 0; city < setting.CityCount(); ++city)
+	{
+		rideTermSum += ComputeCityRideTerm(city, packages, occupancy, setting);
+	}
+
+	int flightTerm = ComputeFlightTerm(airplanes, packages, occupancy, setting);
+
+	return CombineHeuristicTerms(transferCostSum, rideTermSum, flightTerm);
+}
+
+int LogConfiguration::CombineHeuristicTerms(int transferCostSum, int rideTermSum, int flightTerm)
+{
+	return transferCostSum + rideTermSum * Action::driveCost + flightTerm * Action::flyCost;
+}
+
+int LogConfiguration::ComputeTransferCost(const Package& package, const LogSetting& setting)
 {
 	int cumulativeCost = 0;
 
-#pragma region countingPackageTransfers
-	// Handle the loading and unloading of packages and cumulate destinations.
-	for (int place = 0; place < setting.PlaceCount(); ++place)
+	// Handle the loading and unloading of the package.
+	bool differentCity = setting.GetPlaceCity(package.position) != setting.GetPlaceCity(package.destination);
+	if (!differentCity)
 	{
-		for (const Package& package : packages)
+		if (package.state == Package::State::IN_PLANE)
 		{
-			if (package.position == place)
+			cumulativeCost += Action::dropOffCost;
+		}
+		if (package.position != package.destination)
+		{
+			if (package.state != Package::State::IN_TRUCK)
 			{
-				bool differentCity = setting.GetPlaceCity(package.position) != setting.GetPlaceCity(package.destination);
-				if (!differentCity)
-				{
-					if (package.state == Package::State::IN_PLANE)
-					{
-						cumulativeCost += Action::dropOffCost;
-					}
-					if (package.position != package.destination)
-					{
-						if (package.state != Package::State::IN_TRUCK)
-						{
-							cumulativeCost += Action::loadUnloadCost;
-						}
-						cumulativeCost += Action::loadUnloadCost;
-					}
-					else
-					{
-						if (package.state == Package::State::IN_TRUCK)
-						{
-							cumulativeCost += Action::loadUnloadCost;
-						}
-					}
-				}
-				else
-				{
-					int currentAirport = setting.GetAirports()[setting.GetPlaceCity(package.position)];
-					int destinationAirport = setting.GetAirports()[setting.GetPlaceCity(package.destination)];
-
-					if (currentAirport != package.position)
-					{
-						if (package.state == Package::State::OUT)
-						{
-							cumulativeCost += Action::loadUnloadCost;
-						}
-						cumulativeCost += Action::loadUnloadCost;
-					}
-					if (destinationAirport != package.destination)
-					{
-						cumulativeCost += 2 * Action::loadUnloadCost;
-					}
-
-					if (currentAirport == package.position)
-					{
-						if (package.state == Package::State::IN_TRUCK)
-						{
-							cumulativeCost += Action::loadUnloadCost + Action::pickUpCost;
-						}
-						if (package.state == Package::State::OUT)
-						{
-							cumulativeCost += Action::pickUpCost;
-						}
-					}
-					else
-					{
-						cumulativeCost += Action::pickUpCost;
-					}
-					cumulativeCost += Action::dropOffCost;
-				}
+				cumulativeCost += Action::loadUnloadCost;
+			}
+			cumulativeCost += Action::loadUnloadCost;
+		}
+		else
+		{
+			if (package.state == Package::State::IN_TRUCK)
+			{
+				cumulativeCost += Action::loadUnloadCost;
 			}
 		}
 	}
-#pragma endregion
-
-#pragma region countingRides
-	int rideLoops = 0;
-	int limitRides = 0;
-	std::set<int> placesToVisitTrucks;
-	for (int city = 0; city < setting.CityCount(); ++city)
+	else
 	{
-		// Create an oriented graph for necessary package rides.
-		OrientedGraph rideGraph(setting.GetCityPlaces(city).size());
+		int currentAirport = setting.GetPlaceAirport(package.position);
+		int destinationAirport = setting.GetPlaceAirport(package.destination);
 
-		for (auto&& package : packages)
+		if (currentAirport != package.position)
 		{
-			if (setting.GetPlaceCity(package.position) == city)
+			if (package.state == Package::State::OUT)
 			{
-				if (setting.GetPlaceCity(package.position) == setting.GetPlaceCity(package.destination))
-				{
-					if (package.position != package.destination)
-					{
-						rideGraph.AddOrientedEdge(package.position, package.destination);
-					}
-				}
-				else
+				cumulativeCost += Action::loadUnloadCost;
+			}
+			cumulativeCost += Action::loadUnloadCost;
+		}
+		if (destinationAirport != package.destination)
+		{
+			cumulativeCost += 2 * Action::loadUnloadCost;
+		}
+
+		if (currentAirport == package.position)
+		{
+			if (package.state == Package::State::IN_TRUCK)
+			{
+				cumulativeCost += Action::loadUnloadCost + Action::pickUpCost;
+			}
+			if (package.state == Package::State::OUT)
+			{
+				cumulativeCost += Action::pickUpCost;
+			}
+		}
+		else
+		{
+			cumulativeCost += Action::pickUpCost;
+		}
+		cumulativeCost += Action::dropOffCost;
+	}
+
+	return cumulativeCost;
+}
+
+int LogConfiguration::ComputeCityRideTerm(int city,
+	Span<const Package> packages,
+	const Occupancy& occupancy,
+	const LogSetting& setting)
+{
+	// Create an oriented graph for necessary package rides, the vertices are the places of the city.
+	// The graph and the scratch buffers are reused by every evaluation on this thread.
+	thread_local OrientedGraph rideGraph;
+	thread_local std::vector<char> placesToVisitTrucks;
+	int cityPlaceCount = setting.CityPlaceCount(city);
+	rideGraph.Reset(cityPlaceCount);
+
+	for (auto&& package : packages)
+	{
+		if (setting.GetPlaceCity(package.position) == city)
+		{
+			if (setting.GetPlaceCity(package.position) == setting.GetPlaceCity(package.destination))
+			{
+				if (package.position != package.destination)
 				{
-					int airport = setting.GetAirports()[setting.GetPlaceCity(package.position)];
-					if (package.position != airport)
-					{
-						rideGraph.AddOrientedEdge(package.position, airport);
-					}
+					rideGraph.AddOrientedEdge(setting.GetPlaceCityIndex(package.position),
+						setting.GetPlaceCityIndex(package.destination));
 				}
 			}
-			else if (setting.GetPlaceCity(package.destination) == city)
+			else
 			{
-				int airport = setting.GetAirports()[setting.GetPlaceCity(package.destination)];
-				if (airport != package.destination)
+				int airport = setting.GetPlaceAirport(package.position);
+				if (package.position != airport)
 				{
-					rideGraph.AddOrientedEdge(airport, package.destination);
+					rideGraph.AddOrientedEdge(setting.GetPlaceCityIndex(package.position),
+						setting.GetPlaceCityIndex(airport));
 				}
 			}
 		}
-
-		// Some trucks may already be in a place where there is at least one package.
-		std::set<int> occupiedPlaces;
-		for (auto&& truck : trucks)
+		else if (setting.GetPlaceCity(package.destination) == city)
 		{
-			for (auto&& package : packages)
+			int airport = setting.GetPlaceAirport(package.destination);
+			if (airport != package.destination)
 			{
-				if (package.position == truck.position && occupiedPlaces.find(truck.position) == occupiedPlaces.end())
-				{
-					occupiedPlaces.insert(truck.position);
-				}
+				rideGraph.AddOrientedEdge(setting.GetPlaceCityIndex(airport),
+					setting.GetPlaceCityIndex(package.destination));
 			}
 		}
+	}
 
-		// Count the loops that will cause a truck to return to alread visited places.
-		rideLoops += rideGraph.GetLoopCountBreakLoops(occupiedPlaces);
-		rideGraph.EstablishLayerFlow();
-		limitRides += rideGraph.LimitLayerFlow(4);
+	// Some trucks may already be in a place where there is at least one package.
+	for (int place : setting.GetCityPlaces(city))
+	{
+		if (occupancy.HasTruckAt(place) && occupancy.PackageCountAt(place) > 0)
+		{
+			rideGraph.SetOccupied(setting.GetPlaceCityIndex(place));
+		}
+	}
+	auto isOccupied = [&](int place) { return rideGraph.IsOccupied(setting.GetPlaceCityIndex(place)); };
 
-		for (auto&& package : packages)
+	// Every package adds the places it needs to be driven between to the city they lie in.
+	placesToVisitTrucks.assign(cityPlaceCount, 0);
+	auto visit = [&](int place) { placesToVisitTrucks[setting.GetPlaceCityIndex(place)] = 1; };
+	for (auto&& package : packages)
+	{
+		int positionCity = setting.GetPlaceCity(package.position);
+		int destinationCity = setting.GetPlaceCity(package.destination);
+		if (positionCity == destinationCity)
 		{
-			if (package.position != package.destination && 
-				setting.GetPlaceCity(package.position) == setting.GetPlaceCity(package.destination))
+			if (positionCity == city && package.position != package.destination)
 			{
-				if (occupiedPlaces.find(package.position) == occupiedPlaces.end())
+				if (!isOccupied(package.position))
 				{
-					placesToVisitTrucks.insert(package.position);
+					visit(package.position);
 				}
-				placesToVisitTrucks.insert(package.destination);
+				visit(package.destination);
 			}
-			else if (setting.GetPlaceCity(package.position) != setting.GetPlaceCity(package.destination))
+		}
+		else
+		{
+			int posAirport = setting.GetPlaceAirport(package.position);
+			int destAirport = setting.GetPlaceAirport(package.destination);
+			if (positionCity == city && package.position != posAirport)
 			{
-				int posAirport = setting.GetAirports()[setting.GetPlaceCity(package.position)];
-				int destAirport = setting.GetAirports()[setting.GetPlaceCity(package.destination)];
-				if (setting.GetPlaceCity(package.position) == city &&
-					package.position != posAirport)
+				if (!isOccupied(package.position))
 				{
-					if (occupiedPlaces.find(package.position) == occupiedPlaces.end())
-					{
-						placesToVisitTrucks.insert(package.position);
-					}
-					placesToVisitTrucks.insert(posAirport);
+					visit(package.position);
 				}
-				else if (setting.GetPlaceCity(package.position) == city &&
-					destAirport != package.destination)
+				visit(posAirport);
+			}
+			else if (destinationCity == city && package.position == posAirport &&
+				destAirport != package.destination)
+			{
+				if (!isOccupied(destAirport))
 				{
-					if (occupiedPlaces.find(destAirport) == occupiedPlaces.end())
-					{
-						placesToVisitTrucks.insert(destAirport);
-					}
-					placesToVisitTrucks.insert(package.destination);
+					visit(destAirport);
 				}
+				visit(package.destination);
 			}
 		}
 	}
-#pragma endregion
+	int placesToVisitCount = 0;
+	for (char place : placesToVisitTrucks)
+	{
+		placesToVisitCount += place;
+	}
+
+	// Count the loops that will cause a truck to return to alread visited places.
+	int rideLoops = rideGraph.GetLoopCountBreakLoops();
+	rideGraph.EstablishLayerFlow();
+	int limitRides = rideGraph.LimitLayerFlow(4);
+
+	return rideLoops + limitRides + placesToVisitCount;
+}
+
+int LogConfiguration::LookupCityRideTerm(int city,
+	Span<const Package> packages,
+	const Occupancy& occupancy,
+	const LogSetting& setting)
+{
+	CityTermCache& cache = setting.GetCityTermCache();
+	if (cache.Capacity() == 0)
+		return ComputeCityRideTerm(city, packages, occupancy, setting);
+
+	std::uint64_t key = ComputeCityKey(city, packages, occupancy, setting);
+	int cityRideTerm;
+	if (!cache.Find(key, cityRideTerm))
+	{
+		cityRideTerm = ComputeCityRideTerm(city, packages, occupancy, setting);
+		cache.Insert(key, cityRideTerm);
+	}
+	return cityRideTerm;
+}
+
+std::uint64_t LogConfiguration::ComputeCityKey(int city,
+	Span<const Package> packages,
+	const Occupancy& occupancy,
+	const LogSetting& setting)
+{
+	// Every package that adds an edge or a place to visit in the city is described by its kind and
+	// its city-local places. The descriptions are sorted, so that the key does not depend on the package indices.
+	thread_local std::vector<std::uint32_t> descriptions;
+	descriptions.clear();
+
+	for (auto&& package : packages)
+	{
+		int positionCity = setting.GetPlaceCity(package.position);
+		int destinationCity = setting.GetPlaceCity(package.destination);
+		if (positionCity == city && destinationCity == city)
+		{
+			descriptions.push_back((1u << 30) | (setting.GetPlaceCityIndex(package.position) << 15) |
+				setting.GetPlaceCityIndex(package.destination));
+		}
+		else if (positionCity == city)
+		{
+			descriptions.push_back((2u << 30) | (setting.GetPlaceCityIndex(package.position) << 15));
+		}
+		else if (destinationCity == city)
+		{
+			std::uint32_t atAirport = setting.IsAirport(package.position);
+			descriptions.push_back((3u << 30) | (atAirport << 15) | setting.GetPlaceCityIndex(package.destination));
+		}
+	}
+
+	// Each of the occupied places is described once.
+	for (int place : setting.GetCityPlaces(city))
+	{
+		if (occupancy.HasTruckAt(place) && occupancy.PackageCountAt(place) > 0)
+		{
+			descriptions.push_back(setting.GetPlaceCityIndex(place));
+		}
+	}
+	std::sort(descriptions.begin(), descriptions.end());
 
-#pragma region countingFlights
-	// Similarly for flights.
+	std::uint64_t key = MixHash((std::uint64_t)city + 1);
+	for (std::uint32_t description : descriptions)
+	{
+		key = MixHash(key ^ description);
+	}
+	return key;
+}
 
-	OrientedGraph flightGraph(setting.CityCount());
+int LogConfiguration::ComputeFlightTerm(Span<const Airplane> airplanes,
+	Span<const Package> packages,
+	const Occupancy& occupancy,
+	const LogSetting& setting)
+{
+	thread_local OrientedGraph flightGraph;
+	thread_local std::vector<char> placesToVisitPlanes;
+	flightGraph.Reset(setting.CityCount());
 
 	for (auto&& package : packages)
 	{
@@ -448,59 +1038,130 @@ int LogConfiguration::ComputeHeuristic(const std::vector<Vehicle>& trucks,
 	}
 
 	// Some planes may already be in a city where there is at least one package that needs to fly to a different city.
-	std::set<int> occupiedCities;
 	for (auto&& plane : airplanes)
 	{
-		for (auto&& package : packages)
+		int planePositionCity = setting.GetPlaceCity(plane.position);
+		if (occupancy.CityPackageCount(planePositionCity) > 0)
 		{
-			int packagePositionCity = setting.GetPlaceCity(package.position);
-			int planePositionCity = setting.GetPlaceCity(plane.position);
-			if (packagePositionCity == planePositionCity && occupiedCities.find(planePositionCity) == occupiedCities.end())
-			{
-				occupiedCities.insert(planePositionCity);
-			}
+			flightGraph.SetOccupied(planePositionCity);
 		}
 	}
 
-	// Count the loops that will cause a plane to return to alread visited places.
-	int flightLoops = flightGraph.GetLoopCountBreakLoops(occupiedCities);
-	flightGraph.EstablishLayerFlow();
-	int limitFlights = flightGraph.LimitLayerFlow(30);
-
-	std::set<int> placesToVisitPlanes;
+	placesToVisitPlanes.assign(setting.CityCount(), 0);
 	for (auto&& package : packages)
 	{
 		int positionCity = setting.GetPlaceCity(package.position);
 		int destinationCity = setting.GetPlaceCity(package.destination);
 		if (positionCity != destinationCity)
 		{
-			if (occupiedCities.find(positionCity) == occupiedCities.end())
+			if (!flightGraph.IsOccupied(positionCity))
 			{
-				placesToVisitPlanes.insert(positionCity);
+				placesToVisitPlanes[positionCity] = 1;
 			}
-			placesToVisitPlanes.insert(destinationCity);
+			placesToVisitPlanes[destinationCity] = 1;
 		}
 	}
-#pragma endregion
+	int placesToVisitCount = 0;
+	for (char city : placesToVisitPlanes)
+	{
+		placesToVisitCount += city;
+	}
 
-	int rideCount = placesToVisitTrucks.size() + rideLoops + limitRides;
-	int flightCount = placesToVisitPlanes.size() + flightLoops + limitFlights;
-	
-	cumulativeCost += rideCount * Action::driveCost;
-	cumulativeCost += flightCount * Action::flyCost;
+	// Count the loops that will cause a plane to return to alread visited places.
+	int flightLoops = flightGraph.GetLoopCountBreakLoops();
+	flightGraph.EstablishLayerFlow();
+	int limitFlights = flightGraph.LimitLayerFlow(30);
 
-	return cumulativeCost;
+	return placesToVisitCount + flightLoops + limitFlights;
+}
+
+std::uint64_t LogConfiguration::HashTruck(int truck, const Truck& truckObject)
+{
+	return MixHash((1ULL << 62) ^ ((std::uint64_t)truck << 32) ^ (std::uint32_t)truckObject.position);
+}
+
+std::uint64_t LogConfiguration::HashAirplane(int airplane, const Airplane& airplaneObject)
+{
+	return MixHash((2ULL << 62) ^ ((std::uint64_t)airplane << 32) ^ (std::uint32_t)airplaneObject.position);
+}
+
+std::uint64_t LogConfiguration::HashPackage(int package, const Package& packageObject)
+{
+	// The load of the vehicles is given by the state and vehicle of the packages, so it does not need to be hashed.
+	std::uint64_t value = (std::uint64_t)(std::uint32_t)packageObject.position |
+		((std::uint64_t)packageObject.state << 24) | ((std::uint64_t)(packageObject.vehicle + 1) << 28);
+	return MixHash((3ULL << 62) ^ ((std::uint64_t)package << 40) ^ value);
+}
+
+std::uint64_t LogConfiguration::ComputeHash(Span<const Truck> trucks,
+	Span<const Airplane> airplanes,
+	Span<const Package> packages)
+{
+	std::uint64_t result = 0;
+	for (int truck = 0; truck < trucks.size(); ++truck)
+	{
+		result ^= HashTruck(truck, trucks[truck]);
+	}
+	for (int airplane = 0; airplane < airplanes.size(); ++airplane)
+	{
+		result ^= HashAirplane(airplane, airplanes[airplane]);
+	}
+	for (int package = 0; package < packages.size(); ++package)
+	{
+		result ^= HashPackage(package, packages[package]);
+	}
+	return result;
 }
 
-IState* LogConfiguration::Clone() const
+template <int Capacity>
+std::uint64_t LogConfiguration::SymmetricHashVehicle(std::uint64_t kind, const Vehicle<Capacity>& vehicle,
+	Span<const Package> packages)
 {
-	auto trucks = trucks_;
-	auto airplanes = airplanes_;
-	auto packages = packages_;
-	LogConfiguration* result = new LogConfiguration(trucks, airplanes, packages, heuristic);
+	// The sum of the hashes of the destinations does not depend on the order of the load.
+	std::uint64_t loadHash = 0;
+	for (int package : vehicle.load)
+	{
+		loadHash += MixHash((std::uint64_t)(std::uint32_t)packages[package].destination + 1);
+	}
+	return MixHash(MixHash((kind << 62) ^ (std::uint32_t)vehicle.position) ^ loadHash);
+}
+
+std::uint64_t LogConfiguration::SymmetricHashPackage(const Package& packageObject)
+{
+	if (packageObject.state != Package::State::OUT)
+		return 0;
+	return MixHash((3ULL << 62) ^ ((std::uint64_t)(std::uint32_t)packageObject.destination << 32) ^
+		(std::uint32_t)packageObject.position);
+}
+
+std::uint64_t LogConfiguration::ComputeSymmetricHash(Span<const Truck> trucks,
+	Span<const Airplane> airplanes,
+	Span<const Package> packages)
+{
+	std::uint64_t result = 0;
+	for (const Truck& truck : trucks)
+	{
+		result += SymmetricHashVehicle(1, truck, packages);
+	}
+	for (const Airplane& airplane : airplanes)
+	{
+		result += SymmetricHashVehicle(2, airplane, packages);
+	}
+	for (const Package& package : packages)
+	{
+		result += SymmetricHashPackage(package);
+	}
 	return result;
 }
 
+void LogConfiguration::UpdateHash(const LogSetting& setting)
+{
+	if (setting.SymmetryReduction())
+		hash_ = ComputeSymmetricHash(GetTrucksConstReference(), GetAirplanesConstReference(), GetPackagesConstReference());
+	else
+		hash_ = ComputeHash(GetTrucksConstReference(), GetAirplanesConstReference(), GetPackagesConstReference());
+}
+
 int LogConfiguration::LoadConfiguration(const std::string& file, const LogSetting& setting)
 {
 	std::ifstream ifs(file);
@@ -520,35 +1181,35 @@ int LogConfiguration::LoadConfiguration(const std::string& file, const LogSettin
 	while (line[0] == '%')
 		std::getline(ifs, line);
 	int truckCount = stoi(line);
-	trucks_.resize(truckCount);
+	std::vector<Truck> trucks(truckCount);
 
 	for (int truck = 0; truck < truckCount; ++truck)
 	{
 		std::getline(ifs, line);
 		while (line[0] == '%')
 			std::getline(ifs, line);
-		trucks_[truck].position = stoi(line);
+		trucks[truck].position = stoi(line);
 	}
 
 	std::getline(ifs, line);
 	while (line[0] == '%')
 		std::getline(ifs, line);
 	int airplaneCount = stoi(line);
-	airplanes_.resize(airplaneCount);
+	std::vector<Airplane> airplanes(airplaneCount);
 
 	for (int airplane = 0; airplane < airplaneCount; ++airplane)
 	{
 		std::getline(ifs, line);
 		while (line[0] == '%')
 			std::getline(ifs, line);
-		airplanes_[airplane].position = stoi(line);
+		airplanes[airplane].position = stoi(line);
 	}
 
 	std::getline(ifs, line);
 	while (line[0] == '%')
 		std::getline(ifs, line);
 	int packageCount = stoi(line);
-	packages_.resize(packageCount);
+	std::vector<Package> packages(packageCount);
 
 	for (int package = 0; package < packageCount; ++package)
 	{
@@ -561,18 +1222,40 @@ int LogConfiguration::LoadConfiguration(const std::string& file, const LogSettin
 		std::string locationString = line.substr(0, spacePosition);
 		std::string destinationString = line.substr(spacePosition + 1, line.length() - spacePosition);
 
-		packages_[package].position = stoi(locationString);
-		packages_[package].destination = stoi(destinationString);
+		packages[package].position = stoi(locationString);
+		packages[package].destination = stoi(destinationString);
 
-		packages_[package].state = Package::State::OUT;
-		packages_[package].vehicle = -1;
+		packages[package].state = Package::State::OUT;
+		packages[package].vehicle = -1;
 	}
 
 	ifs.close();
 
-	return ComputeHeuristic(trucks_, airplanes_, packages_, setting);
+	InitializeObjects(trucks, airplanes, packages, setting);
+	return heuristic_;
+}
+
+void LogConfiguration::InitializeObjects(const std::vector<Truck>& trucks, const std::vector<Airplane>& airplanes,
+	const std::vector<Package>& packages, const LogSetting& setting)
+{
+	// Pack the objects into the configuration block.
+	AllocateData((int)trucks.size(), (int)airplanes.size(), (int)packages.size(), setting.CityCount(),
+		setting.PlaceCount());
+	std::uninitialized_copy(trucks.begin(), trucks.end(), Trucks());
+	std::uninitialized_copy(airplanes.begin(), airplanes.end(), Airplanes());
+	std::uninitialized_copy(packages.begin(), packages.end(), Packages());
+	GetOccupancy().Build(GetTrucksConstReference(), GetAirplanesConstReference(), GetPackagesConstReference(), setting);
+
+	UpdateHash(setting);
+	InitializeHeuristicTerms(setting);
 }
 
+LogSetting::LogSetting(const LogSetting& other)
+	: cityCount_(other.cityCount_), places_(other.places_), placeCityIndices_(other.placeCityIndices_),
+	cityPlaceStarts_(other.cityPlaceStarts_), cityPlaces_(other.cityPlaces_), airports_(other.airports_),
+	placeAirports_(other.placeAirports_),
+	cityTermCache_(other.cityTermCache_.Capacity()), symmetryReduction_(other.symmetryReduction_) {}
+
 LogSetting::LogSetting(const std::string& file)
 {
 	std::ifstream ifs(file);
@@ -601,6 +1284,23 @@ LogSetting::LogSetting(const std::string& file)
 		places_[place] = stoi(line);
 	}
 
+	// Number the places within their cities, then place each city's places after the places of the previous cities.
+	placeCityIndices_.resize(placeCount);
+	cityPlaceStarts_.assign(cityCount_ + 1, 0);
+	for (int place = 0; place < placeCount; ++place)
+	{
+		placeCityIndices_[place] = cityPlaceStarts_[places_[place] + 1]++;
+	}
+	for (int city = 0; city < cityCount_; ++city)
+	{
+		cityPlaceStarts_[city + 1] += cityPlaceStarts_[city];
+	}
+	cityPlaces_.resize(placeCount);
+	for (int place = 0; place < placeCount; ++place)
+	{
+		cityPlaces_[cityPlaceStarts_[places_[place]] + placeCityIndices_[place]] = place;
+	}
+
 	airports_.resize(cityCount_);
 
 	for (int airport = 0; airport < cityCount_; ++airport)
@@ -611,58 +1311,27 @@ LogSetting::LogSetting(const std::string& file)
 		airports_[airport] = stoi(line);
 	}
 	ifs.close();
-}
 
-std::vector<int> LogSetting::GetCityPlaces(int city) const
-{
-	std::vector<int> places;
-	for (int place = 0; place < places_.size(); ++place)
+	placeAirports_.resize(placeCount);
+	for (int place = 0; place < placeCount; ++place)
 	{
-		if (places_[place] == city)
-			places.push_back(place);
+		placeAirports_[place] = airports_[places_[place]];
 	}
-	return places;
 }
 
-int LogSetting::GetPlaceCity(int place) const
+IAction* LogAction::Clone() const
 {
-	return places_[place];
+	return new LogAction(action);
 }
 
-Action::Action(Type type, std::pair<int, int> valuePair)
-	: type(type), valuePair(valuePair)
+LogState::LogState(LogConfiguration configuration)
+	: configuration_(std::move(configuration))
 {
-	switch (type)
-	{
-	case Action::Type::DRIVE:
-		cost = driveCost;
-		break;
-	case Action::Type::LOAD:
-	case Action::Type::UNLOAD:
-		cost = loadUnloadCost;
-		break;
-	case Action::Type::FLY:
-		cost = flyCost;
-		break;
-	case Action::Type::PICK_UP:
-		cost = pickUpCost;
-		break;
-	case Action::Type::DROP_OFF:
-		cost = dropOffCost;
-		break;
-	default:
-		throw std::runtime_error("Undefined action value!");
-		break;
-	}
+	heuristic = configuration_.Heuristic();
+	hash = configuration_.Hash();
 }
 
-IAction* Action::Clone() const
+IState* LogState::Clone() const
 {
-	Action* result = new Action;
-
-	result->cost = cost;
-	((Action*)result)->type = type;
-	((Action*)result)->valuePair = valuePair;
-
-	return result;
+	return new LogState(*this);
 }
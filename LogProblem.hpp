@@ -1,31 +1,99 @@
 #pragma once
 #include "AStarInterface.hpp"
+#include "CityTermCache.hpp"
+#include "ThreadPool.hpp"
+#include <memory>
 #include <vector>
 #include <unordered_set>
+#include <string>
+#include <stdexcept>
+
+//#define OVERCAPACITY_LOG
+
+#ifdef OVERCAPACITY_LOG
+#include <iostream>
+#endif
+
+class HeuristicEngine;
+
+// A non-owning view of a contiguous array of objects.
+template <typename T>
+class Span
+{
+public:
+	Span(T* data, int size) : data_(data), size_(size) {}
+
+	int size() const { return size_; }
+	bool empty() const { return size_ == 0; }
+	T* begin() const { return data_; }
+	T* end() const { return data_ + size_; }
+	T& operator[](int index) const { return data_[index]; }
+
+	operator Span<const T>() const { return Span<const T>(data_, size_); }
+private:
+	T* data_;
+	int size_;
+};
 
 // This is the description of non-changeable facts about the problem, e.g. the cities and places.
+// The map is indexed when it is loaded, so that the lookups are array reads that do not allocate.
 class LogSetting
 {
 public:
 	LogSetting(const std::string& file);
+	// Copies the map and the options, except the heuristic engine (which is built for the objects of a problem).
+	// The cache of the city ride terms starts empty.
+	LogSetting(const LogSetting& other);
+	LogSetting& operator=(const LogSetting&) = delete;
 
 	int CityCount() const { return (int)cityCount_; }
 	int PlaceCount() const { return (int)places_.size(); }
 
-	std::vector<int> GetCityPlaces(int city) const;
+	// Returns the places of the city, in the order of their indices among the places of the city.
+	Span<const int> GetCityPlaces(int city) const
+	{
+		return Span<const int>(cityPlaces_.data() + cityPlaceStarts_[city], CityPlaceCount(city));
+	}
+	int CityPlaceCount(int city) const { return cityPlaceStarts_[city + 1] - cityPlaceStarts_[city]; }
 
-	int GetPlaceCity(int place) const;
+	int GetPlaceCity(int place) const { return places_[place]; }
+	// Returns the index of the place among the places of its city.
+	int GetPlaceCityIndex(int place) const { return placeCityIndices_[place]; }
 
+	// Returns the airports of the cities.
 	const std::vector<int>& GetAirports() const { return airports_; };
+	// Returns the airport of the city of the place.
+	int GetPlaceAirport(int place) const { return placeAirports_[place]; }
+	bool IsAirport(int place) const { return placeAirports_[place] == place; }
+
+	// The cache of the city ride terms computed for this setting (the terms depend only on the setting
+	// and the city-local part of a configuration).
+	CityTermCache& GetCityTermCache() const { return cityTermCache_; }
+
+	// Whether the configurations are hashed up to their symmetries (see LogConfiguration::Hash).
+	bool SymmetryReduction() const { return symmetryReduction_; }
+	void SetSymmetryReduction(bool reduce) { symmetryReduction_ = reduce; }
+
+	// The engine the heuristic is computed by from the whole configuration, nullptr (the default) if none.
+	const HeuristicEngine* GetHeuristicEngine() const { return heuristicEngine_.get(); }
+	void SetHeuristicEngine(std::shared_ptr<const HeuristicEngine> engine) { heuristicEngine_ = std::move(engine); }
 private:
 	int cityCount_;
+	// The city of every place.
 	std::vector<int> places_;
+	std::vector<int> placeCityIndices_;
+	// The places of all the cities one city after another, the places of a city start at its start.
+	std::vector<int> cityPlaceStarts_;
+	std::vector<int> cityPlaces_;
 	std::vector<int> airports_;
+	std::vector<int> placeAirports_;
+	mutable CityTermCache cityTermCache_;
+	bool symmetryReduction_ = false;
+	std::shared_ptr<const HeuristicEngine> heuristicEngine_;
 };
 
-class LogConfiguration;
-
-class Action : public IAction
+// An action of the problem, a plain value, so that the search can store it without a virtual table.
+class Action
 {
 public:
 	enum class Type
@@ -47,19 +115,82 @@ public:
 	static const int dropOffCost = 11;
 
 	Action() = default;
-	virtual ~Action() override {};
+	Action(Type type, std::pair<int, int> valuePair) : type(type), valuePair(valuePair) {}
+
+	bool operator==(const Action& other) const { return type == other.type && valuePair == other.valuePair; }
+
+	int Cost() const
+	{
+		switch (type)
+		{
+		case Type::DRIVE:
+			return driveCost;
+		case Type::LOAD:
+		case Type::UNLOAD:
+			return loadUnloadCost;
+		case Type::FLY:
+			return flyCost;
+		case Type::PICK_UP:
+			return pickUpCost;
+		case Type::DROP_OFF:
+			return dropOffCost;
+		default:
+			throw std::runtime_error("Undefined action value!");
+		}
+	}
+};
 
-	Action(Type type, std::pair<int, int> valuePair);
+// The action as an action of the virtual search interface (IProblem).
+class LogAction : public IAction
+{
+public:
+	Action action;
+
+	LogAction(const Action& action) : action(action) { cost = action.Cost(); }
 
 	virtual IAction* Clone() const override;
 };
 
+// A set of package indices stored inline, so that the vehicle carrying it can be copied with memcpy.
+// Inserting into a full load or inserting a package twice is not checked.
+template <int Capacity>
+class InlineLoad
+{
+public:
+	int size() const { return count_; }
+	bool empty() const { return count_ == 0; }
+	const int* begin() const { return items_; }
+	const int* end() const { return items_ + count_; }
+
+	void insert(int package) { items_[count_++] = package; }
+	void erase(int package)
+	{
+		for (int i = 0; i < count_; ++i)
+		{
+			if (items_[i] == package)
+			{
+				items_[i] = items_[--count_];
+				return;
+			}
+		}
+	}
+private:
+	int count_ = 0;
+	int items_[Capacity];
+};
+
+template <int Capacity>
 struct Vehicle
 {
+	static const int capacity = Capacity;
+
 	int position;
-	std::unordered_set<int> load;
+	InlineLoad<Capacity> load;
 };
 
+using Truck = Vehicle<4>;
+using Airplane = Vehicle<30>;
+
 struct Package
 {
 	int position;
@@ -74,56 +205,443 @@ struct Package
 	int vehicle;
 };
 
+// The index of where the objects of a configuration are: the trucks and the airplanes at every place, as lists sorted
+// by their indices, and the number of the packages (in any state) at every place and in every city.
+// It is a view of a part of the configuration block, which LogConfiguration keeps up to date on every action,
+// so that the actions at a place and the occupied places are found without going through all the objects.
+class Occupancy
+{
+public:
+	// The number of ints the index of a configuration takes.
+	static size_t IndexSize(int placeCount, int truckCount, int airplaneCount, int cityCount)
+	{
+		return 3 * (size_t)placeCount + truckCount + airplaneCount + cityCount;
+	}
+
+	Occupancy(int* index, int placeCount, int truckCount, int airplaneCount)
+		: firstTrucks_(index), nextTrucks_(firstTrucks_ + placeCount),
+		firstAirplanes_(nextTrucks_ + truckCount), nextAirplanes_(firstAirplanes_ + placeCount),
+		placePackageCounts_(nextAirplanes_ + airplaneCount), cityPackageCounts_(placePackageCounts_ + placeCount) {}
+
+	// The lists of the vehicles at a place end with -1.
+	int FirstTruckAt(int place) const { return firstTrucks_[place]; }
+	int NextTruck(int truck) const { return nextTrucks_[truck]; }
+	int FirstAirplaneAt(int place) const { return firstAirplanes_[place]; }
+	int NextAirplane(int airplane) const { return nextAirplanes_[airplane]; }
+	bool HasTruckAt(int place) const { return firstTrucks_[place] >= 0; }
+	int PackageCountAt(int place) const { return placePackageCounts_[place]; }
+	int CityPackageCount(int city) const { return cityPackageCounts_[city]; }
+private:
+	friend class LogConfiguration;
+
+	// Indexes the objects from scratch.
+	void Build(Span<const Truck> trucks, Span<const Airplane> airplanes, Span<const Package> packages,
+		const LogSetting& setting);
+	void MoveTruck(int truck, int from, int to)
+	{
+		Unlink(firstTrucks_, nextTrucks_, truck, from);
+		Link(firstTrucks_, nextTrucks_, truck, to);
+	}
+	void MoveAirplane(int airplane, int from, int to)
+	{
+		Unlink(firstAirplanes_, nextAirplanes_, airplane, from);
+		Link(firstAirplanes_, nextAirplanes_, airplane, to);
+	}
+	void MovePackages(int count, int from, int to, const LogSetting& setting);
+	// Insert the vehicle into the list of the place, keeping it sorted, and remove it from the list.
+	static void Link(int* first, int* next, int vehicle, int place);
+	static void Unlink(int* first, int* next, int vehicle, int place);
+
+	int* firstTrucks_;
+	int* nextTrucks_;
+	int* firstAirplanes_;
+	int* nextAirplanes_;
+	int* placePackageCounts_;
+	int* cityPackageCounts_;
+};
+
 // This is the description of the current configuration, i.e. state of the changeable parts of the problem.
-class LogConfiguration : public IState
+// The trucks, airplanes and packages are stored one after another in a single block of memory, together with
+// their Occupancy index, so copying a configuration is one allocation and one memcpy.
+// The heuristic is kept as a sum of terms (per package transfers, per city rides and flights), so that applying
+// an action only computes again the terms the action changes. With the heuristic engine of the setting,
+// the heuristic is computed by the engine instead, after every action.
+class LogConfiguration
 {
 public:
+	// The parts of a configuration an action changes, saved by ApplyAction to be restored by UndoAction.
+	struct Undo
+	{
+		std::uint64_t hash;
+		int heuristic;
+		int transferCostSum;
+		int rideTermSum;
+		int flightTerm;
+		// The vehicle of the action (a truck or an airplane, depending on the type of the action).
+		Truck truck;
+		Airplane airplane;
+		// The packages the action changed and their previous values.
+		int packageCount;
+		int packages[Airplane::capacity];
+		Package packageValues[Airplane::capacity];
+		// The cities whose ride terms the action changed and their previous ride terms.
+		int cityCount;
+		int cities[Airplane::capacity + 2];
+		int cityRideTerms[Airplane::capacity + 2];
+	};
+
+	// Creates an empty configuration, to be assigned to.
+	LogConfiguration() = default;
 	LogConfiguration(const std::string& file, const LogSetting& setting);
+	LogConfiguration(const std::vector<Truck>& trucks, const std::vector<Airplane>& airplanes,
+		const std::vector<Package>& packages, const LogSetting& setting);
+	LogConfiguration(const LogConfiguration& other);
+	LogConfiguration(LogConfiguration&& other) noexcept = default;
+	// Copies the other configuration, reusing the memory of this one if the sizes match.
+	LogConfiguration& operator=(const LogConfiguration& other);
+	LogConfiguration& operator=(LogConfiguration&& other) noexcept = default;
 
-	LogConfiguration(std::vector<Vehicle>& trucks, std::vector<Vehicle>& airplanes,
-		std::vector<Package>& packages, int heuristic);
+	// Returns the heuristic value of this configuration (how close is it to the solution).
+	int Heuristic() const { return heuristic_; }
+	// Returns the hash of this configuration, equal configurations have equal hashes.
+	// With the symmetry reduction of the setting, so do the configurations that differ only by a swap of trucks
+	// or airplanes at the same place (with their loads), or of packages with the same position and destination,
+	// so the search treats them as one state. The states keep their own objects, so the plans need no remapping.
+	std::uint64_t Hash() const { return hash_; }
+	// Computes the hash from scratch, with or without the symmetry reduction of the setting.
+	void UpdateHash(const LogSetting& setting);
+	// Computes the heuristic from scratch, with the heuristic engine of the setting, if any.
+	void UpdateHeuristic(const LogSetting& setting) { InitializeHeuristicTerms(setting); }
 
-	LogConfiguration* GetNewConfiguration(const Action& action,
+	LogConfiguration GetNewConfiguration(const Action& action,
 		const LogSetting& setting) const;
+	// Applies the action to this configuration and updates the hash and the heuristic.
+	void ApplyAction(const Action& action, const LogSetting& setting);
+	// Applies the action and saves what it changed to the undo, so that UndoAction can take it back.
+	void ApplyAction(const Action& action, const LogSetting& setting, Undo& undo);
+	// Restores the configuration before the action, which must be the last action applied with the undo.
+	void UndoAction(const Action& action, const LogSetting& setting, const Undo& undo);
 
-	std::vector<Vehicle>& GetTrucksReference() { return trucks_; }
-	std::vector<Vehicle>& GetAirplanesReference() { return airplanes_; }
-	std::vector<Package>& GetPackagesReference() { return packages_; }
+	Span<Truck> GetTrucksReference() { return Span<Truck>(Trucks(), truckCount_); }
+	Span<Airplane> GetAirplanesReference() { return Span<Airplane>(Airplanes(), airplaneCount_); }
+	Span<Package> GetPackagesReference() { return Span<Package>(Packages(), packageCount_); }
 
-	const std::vector<Vehicle>& GetTrucksConstReference() const { return trucks_; }
-	const std::vector<Vehicle>& GetAirplanesConstReference() const { return airplanes_; }
-	const std::vector<Package>& GetPackagesConstReference() const { return packages_; }
+	Span<const Truck> GetTrucksConstReference() const { return Span<const Truck>(Trucks(), truckCount_); }
+	Span<const Airplane> GetAirplanesConstReference() const { return Span<const Airplane>(Airplanes(), airplaneCount_); }
+	Span<const Package> GetPackagesConstReference() const { return Span<const Package>(Packages(), packageCount_); }
+	Occupancy GetOccupancy() const { return Occupancy(OccupancyIndex(), placeCount_, truckCount_, airplaneCount_); }
 
-	static int ComputeHeuristic(const std::vector<Vehicle>& trucks,
-		const std::vector<Vehicle>& airplanes,
-		const std::vector<Package>& packages,
+	// Computes the heuristic from scratch.
+	static int ComputeHeuristic(Span<const Truck> trucks,
+		Span<const Airplane> airplanes,
+		Span<const Package> packages,
 		const LogSetting& setting);
 
-	virtual IState* Clone() const override;
+	// Computes the hash of the whole configuration, GetNewConfiguration only updates the changed parts.
+	static std::uint64_t ComputeHash(Span<const Truck> trucks,
+		Span<const Airplane> airplanes,
+		Span<const Package> packages);
+	// Computes the hash of the whole configuration up to its symmetries, it is a sum (not a xor) of the hashes
+	// of the objects, so that equal objects do not cancel out.
+	static std::uint64_t ComputeSymmetricHash(Span<const Truck> trucks,
+		Span<const Airplane> airplanes,
+		Span<const Package> packages);
 
 private:
-	std::vector<Vehicle> trucks_;
-	std::vector<Vehicle> airplanes_;
-	std::vector<Package> packages_;
+	int truckCount_ = 0;
+	int airplaneCount_ = 0;
+	int packageCount_ = 0;
+	int cityCount_ = 0;
+	int placeCount_ = 0;
+	// Releases the data the same way the configuration itself is released.
+	struct DataDeleter
+	{
+		void operator()(unsigned char* data) const { SearchArena::FreeObject(data); }
+	};
+	// The trucks, followed by the airplanes, the packages, the ride terms of the cities and the occupancy index.
+	std::unique_ptr<unsigned char, DataDeleter> data_;
+
+	int heuristic_ = -1;
+	std::uint64_t hash_ = 0;
+	// The terms the heuristic is combined from.
+	int transferCostSum_ = 0;
+	int rideTermSum_ = 0;
+	int flightTerm_ = 0;
+
+	size_t DataSize() const;
+	void AllocateData(int truckCount, int airplaneCount, int packageCount, int cityCount, int placeCount);
+	Truck* Trucks() const { return (Truck*)data_.get(); }
+	Airplane* Airplanes() const { return (Airplane*)(data_.get() + truckCount_ * sizeof(Truck)); }
+	Package* Packages() const { return (Package*)(data_.get() + truckCount_ * sizeof(Truck) + airplaneCount_ * sizeof(Airplane)); }
+	int* CityRideTerms() const { return (int*)(Packages() + packageCount_); }
+	int* OccupancyIndex() const { return CityRideTerms() + cityCount_; }
+
+	void ApplyAction(const Action& action, const LogSetting& setting, Undo* undo);
+	void SaveUndo(const Action& action, Undo& undo) const;
+
+	// Removes the hash and the transfer cost of the package, before it is changed.
+	void DetachPackage(int package, const LogSetting& setting);
+	// Adds the hash and the transfer cost of the package, after it was changed.
+	void AttachPackage(int package, const LogSetting& setting);
+	// Remove the hash of the vehicle before it is changed and add it after.
+	void DetachTruck(int truck, const LogSetting& setting);
+	void AttachTruck(int truck, const LogSetting& setting);
+	void DetachAirplane(int airplane, const LogSetting& setting);
+	void AttachAirplane(int airplane, const LogSetting& setting);
+	void InitializeHeuristicTerms(const LogSetting& setting);
+
+	static int CombineHeuristicTerms(int transferCostSum, int rideTermSum, int flightTerm);
+	static int ComputeTransferCost(const Package& package, const LogSetting& setting);
+	static int ComputeCityRideTerm(int city, Span<const Package> packages, const Occupancy& occupancy,
+		const LogSetting& setting);
+	// Returns the ride term of the city from the cache of the setting, computes it on a miss.
+	static int LookupCityRideTerm(int city, Span<const Package> packages, const Occupancy& occupancy,
+		const LogSetting& setting);
+	// Hashes the parts of the configuration the ride term of the city depends on, independently of their order.
+	static std::uint64_t ComputeCityKey(int city, Span<const Package> packages, const Occupancy& occupancy,
+		const LogSetting& setting);
+	static int ComputeFlightTerm(Span<const Airplane> airplanes, Span<const Package> packages,
+		const Occupancy& occupancy, const LogSetting& setting);
 
 	int LoadConfiguration(const std::string& file, const LogSetting& setting);
+	// Packs the objects into the configuration and computes the hash and the heuristic.
+	void InitializeObjects(const std::vector<Truck>& trucks, const std::vector<Airplane>& airplanes,
+		const std::vector<Package>& packages, const LogSetting& setting);
 	static int TruckRideCheck(int location, int destination, Package::State packageState);
+	static std::uint64_t HashTruck(int truck, const Truck& truckObject);
+	static std::uint64_t HashAirplane(int airplane, const Airplane& airplaneObject);
+	static std::uint64_t HashPackage(int package, const Package& packageObject);
+	// The hashes of the objects without their indices. A vehicle is hashed with the destinations of its load,
+	// and a package in a vehicle is hashed only as a part of it.
+	template <int Capacity>
+	static std::uint64_t SymmetricHashVehicle(std::uint64_t kind, const Vehicle<Capacity>& vehicle, Span<const Package> packages);
+	static std::uint64_t SymmetricHashPackage(const Package& packageObject);
+};
+
+// The configuration as a state of the virtual search interface (IProblem).
+class LogState : public IState
+{
+public:
+	LogState(LogConfiguration configuration);
+
+	const LogConfiguration& GetConfiguration() const { return configuration_; }
+
+	virtual IState* Clone() const override;
+private:
+	LogConfiguration configuration_;
+};
+
+// A successor of a configuration, that applies its action to a scratch configuration only when it is evaluated.
+class ConfigurationSuccessor
+{
+public:
+	ConfigurationSuccessor(const LogConfiguration& configuration, const Action& action, const LogSetting& setting)
+		: configuration_(configuration), action_(action), setting_(setting), id_(++lastId_) {}
+	// A successor that was already evaluated to the given configuration.
+	ConfigurationSuccessor(const LogConfiguration& configuration, const Action& action, const LogSetting& setting,
+		const LogConfiguration& evaluated)
+		: configuration_(configuration), action_(action), setting_(setting), id_(0), evaluated_(&evaluated) {}
+
+	const Action& GetAction() const { return action_; }
+	int Cost() const { return action_.Cost(); }
+	int Heuristic() { return Evaluate().Heuristic(); }
+	std::uint64_t Hash() { return Evaluate().Hash(); }
+	LogConfiguration MakeState() { return Evaluate(); }
+	Action MakeAction() const { return action_; }
+private:
+	const LogConfiguration& Evaluate() { return evaluated_ ? *evaluated_ : EvaluateInScratch(); }
+	const LogConfiguration& EvaluateInScratch();
+
+	const LogConfiguration& configuration_;
+	Action action_;
+	const LogSetting& setting_;
+	std::uint64_t id_;
+	const LogConfiguration* evaluated_ = nullptr;
+
+	// The id of the successor created last on this thread.
+	static thread_local std::uint64_t lastId_;
 };
 
 // This is the problem assignment.
+// It implements the virtual IProblem interface and the compile time interface of BasicAStarSolver.
 class LogProblem : public IProblem
 {
 public:
-	static const int truckCapacity = 4;
-	static const int planeCapacity = 30;
+	using StateType = LogConfiguration;
+	using ActionType = Action;
+	using UndoType = LogConfiguration::Undo;
+
+	static const int truckCapacity = Truck::capacity;
+	static const int planeCapacity = Airplane::capacity;
 
 	LogProblem(const std::string& file);
+	// The problem of moving the objects on the map of the setting (copied with its options, see LogSetting).
+	LogProblem(const LogSetting& setting, const std::vector<Truck>& trucks, const std::vector<Airplane>& airplanes,
+		const std::vector<Package>& packages);
+	const LogSetting& GetSetting() const { return setting_; }
+	// Sets the pool the successors of a configuration are evaluated on, all at once, before they are passed
+	// to the visitor in the same order as without it. nullptr (the default) evaluates every successor
+	// on the searching thread, only when the search needs it.
+	void SetEvaluationPool(ThreadPool* pool) { evaluationPool_ = pool; }
 	static void OutputSolution(std::ostream& out, const std::vector<std::unique_ptr<IAction>>& solution);
+	static void OutputSolution(std::ostream& out, const std::vector<Action>& solution);
+	// Sets whether the configurations that differ only by a swap of interchangeable trucks, airplanes or packages
+	// are searched as one state (see LogConfiguration::Hash). Off by default, must not change during a search.
+	void SetSymmetryReduction(bool reduce);
+	// Sets the engine the heuristic is computed by (see HeuristicEngine), created for the setting and the initial
+	// configuration of this problem. nullptr (the default) uses the heuristic of LogConfiguration.
+	// Must not change during a search.
+	void SetHeuristicEngine(std::shared_ptr<const HeuristicEngine> engine);
+
+	const LogConfiguration& InitialState() const { return initialState_->GetConfiguration(); }
+	bool IsGoalState(const LogConfiguration& configuration) const;
+	// Calls visitor(successor) with a ConfigurationSuccessor for every action that can be taken in the configuration.
+	template <typename Visitor>
+	void EnumerateSuccessors(const LogConfiguration& configuration, Visitor& visitor) const;
+	void ApplyAction(LogConfiguration& configuration, const Action& action, UndoType& undo) const
+	{
+		configuration.ApplyAction(action, setting_, undo);
+	}
+	void UndoAction(LogConfiguration& configuration, const Action& action, const UndoType& undo) const
+	{
+		configuration.UndoAction(action, setting_, undo);
+	}
+	// Returns true if the action applied right after previous can be applied before it instead, reaching the same
+	// configuration at the same cost, and the action comes before previous in the order of the types and the values.
+	// The actions of different vehicles on different packages commute, and so do the loads and unloads of one vehicle
+	// on different packages (except for a load after an unload, which could overfill the vehicle before it).
+	bool IsRedundantAfter(const Action& previous, const Action& action) const;
+
 	virtual IState const* GetInitialState() const override;
 	virtual bool IsGoalState(IState const* state) const override;
 	virtual void EnumeratePossibleActions(IState const* state,
 		std::queue<std::pair<IAction*, IState*>>& possibleActions) const override;
+	virtual bool SupportsLazySuccessors() const override { return true; }
+	virtual bool SupportsHashing() const override { return true; }
+	virtual void EnumerateSuccessors(IState const* state, ISuccessorVisitor& visitor) const override;
 private:
+	// Calls function(action) for every action that can be taken in the configuration.
+	template <typename Function>
+	void ForEachAction(const LogConfiguration& configuration, Function function) const;
+	// Applies each of the actions to a copy of the configuration, on the evaluation pool.
+	void EvaluateSuccessors(const LogConfiguration& configuration, const std::vector<Action>& actions,
+		std::vector<LogConfiguration>& successors) const;
+
+	// Fewer successors are evaluated on the searching thread, even with the evaluation pool.
+	static const size_t minParallelSuccessors = 8;
+
 	LogSetting setting_;
-	std::unique_ptr<LogConfiguration> initialConfiguration_;
+	std::unique_ptr<LogState> initialState_;
+	ThreadPool* evaluationPool_ = nullptr;
 };
+
+template <typename Visitor>
+void LogProblem::EnumerateSuccessors(const LogConfiguration& configuration, Visitor& visitor) const
+{
+	if (!evaluationPool_)
+	{
+		ForEachAction(configuration, [&](const Action& action)
+		{
+			ConfigurationSuccessor successor(configuration, action, setting_);
+			visitor(successor);
+		});
+		return;
+	}
+
+	// The visitor does not enumerate successors, so the buffers of a thread are never used twice at once.
+	thread_local std::vector<Action> actions;
+	thread_local std::vector<LogConfiguration> successors;
+	actions.clear();
+	ForEachAction(configuration, [](const Action& action) { actions.push_back(action); });
+	EvaluateSuccessors(configuration, actions, successors);
+	for (size_t i = 0; i < actions.size(); ++i)
+	{
+		ConfigurationSuccessor successor(configuration, actions[i], setting_, successors[i]);
+		visitor(successor);
+	}
+}
+
+template <typename Function>
+void LogProblem::ForEachAction(const LogConfiguration& configuration, Function function) const
+{
+	Span<const Truck> trucks = configuration.GetTrucksConstReference();
+	Span<const Airplane> airplanes = configuration.GetAirplanesConstReference();
+	Span<const Package> packages = configuration.GetPackagesConstReference();
+	Occupancy occupancy = configuration.GetOccupancy();
+
+	// For each truck get all places in the same city and return a configuration of driving.
+	for (int truck = 0; truck < trucks.size(); ++truck)
+	{
+		const Truck& truckObject = trucks[truck];
+		for (int place : setting_.GetCityPlaces(setting_.GetPlaceCity(truckObject.position)))
+		{
+			if (place != truckObject.position)
+			{
+				function(Action(Action::Type::DRIVE, { truck, place }));
+			}
+		}
+	}
+
+	// For all packages that are in trucks or planes, generate an out state.
+	for (int package = 0; package < packages.size(); ++package)
+	{
+		const Package& packageObject = packages[package];
+		if (packageObject.state == Package::State::IN_PLANE)
+		{
+			function(Action(Action::Type::DROP_OFF, { packageObject.vehicle, package }));
+		}
+		else if (packageObject.state == Package::State::IN_TRUCK)
+		{
+			function(Action(Action::Type::UNLOAD, { packageObject.vehicle, package }));
+		}
+	}
+
+	// For all packages that are in a place, where there is a plane or a truck, create a loaded state.
+	for (int package = 0; package < packages.size(); ++package)
+	{
+		const Package& packageObject = packages[package];
+
+		if (packageObject.state == Package::State::OUT)
+		{
+			// The vehicles at the place come in the order of their indices.
+			for (int truck = occupancy.FirstTruckAt(packageObject.position); truck >= 0; truck = occupancy.NextTruck(truck))
+			{
+				if (trucks[truck].load.size() < truckCapacity)
+				{
+					function(Action(Action::Type::LOAD, { truck, package }));
+				}
+#ifdef OVERCAPACITY_LOG
+				else
+				{
+					std::cout << "Over capacity!" << std::endl;
+				}
+#endif
+			}
+
+			for (int airplane = occupancy.FirstAirplaneAt(packageObject.position); airplane >= 0;
+				airplane = occupancy.NextAirplane(airplane))
+			{
+				if (airplanes[airplane].load.size() < planeCapacity)
+				{
+					function(Action(Action::Type::PICK_UP, { airplane, package }));
+				}
+			}
+		}
+	}
+
+	const std::vector<int>& airports = setting_.GetAirports();
+
+	// For all planes create a flight to every other city.
+	for (int airplane = 0; airplane < airplanes.size(); ++airplane)
+	{
+		const Airplane& airplaneObject = airplanes[airplane];
+
+		for (int airport : airports)
+		{
+			if (airport != airplaneObject.position)
+			{
+				function(Action(Action::Type::FLY, { airplane, airport }));
+			}
+		}
+	}
+}
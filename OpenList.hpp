@@ -0,0 +1,240 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <queue>
+#include <vector>
+
+// The open lists of BasicAStarSolver. All of them return the node with the lowest heuristic cost first
+// and the deepest one among the nodes of equal cost. Only IndexedHeapOpenList can find a node in the list
+// and move it after its cost was decreased, the others never contain a node, so that a cheaper path
+// to a state adds a new node.
+
+// An open list kept as a binary heap, every push and pop is O(log n).
+template <typename NodeType>
+class BinaryHeapOpenList
+{
+public:
+	bool empty() const { return heap_.empty(); }
+	void push(NodeType* node) { heap_.push(node); }
+	NodeType* pop()
+	{
+		NodeType* node = heap_.top();
+		heap_.pop();
+		return node;
+	}
+	void clear() { heap_ = Heap(); }
+	bool contains(NodeType const* /*node*/) const { return false; }
+	void decrease(NodeType* /*node*/) {}
+private:
+	struct CompareNodes
+	{
+		bool operator()(NodeType const* n1, NodeType const* n2) const
+		{
+			return n1->heuristicCost > n2->heuristicCost ||
+				(n1->heuristicCost == n2->heuristicCost && n1->depth < n2->depth);
+		}
+	};
+	using Heap = std::priority_queue<NodeType*, std::vector<NodeType*>, CompareNodes>;
+
+	Heap heap_;
+};
+
+// An open list of buckets indexed by the heuristic cost and the depth, push and pop are O(1) amortized.
+// The nodes of the same cost and depth are popped in the order they were pushed.
+// The heuristic costs must be non-negative integers, the number of buckets grows with the highest one
+// (the costs of a deepening iteration are limited by its deepening stop). The nodes of the costs
+// from maxBucketCost up are kept in a binary heap instead, so that a few costly nodes do not allocate
+// a bucket for every cost below theirs.
+template <typename NodeType>
+class BucketOpenList
+{
+public:
+	static const int maxBucketCost = 1 << 20;
+
+	bool empty() const { return size_ == 0 && overflow_.empty(); }
+	void push(NodeType* node)
+	{
+		assert(node->heuristicCost >= 0);
+		if (node->heuristicCost >= maxBucketCost)
+		{
+			overflow_.push(node);
+			return;
+		}
+		if ((size_t)node->heuristicCost >= buckets_.size())
+		{
+			buckets_.resize(node->heuristicCost + 1);
+		}
+		Bucket& bucket = buckets_[node->heuristicCost];
+		if ((size_t)node->depth >= bucket.depths.size())
+		{
+			bucket.depths.resize(node->depth + 1);
+		}
+		bucket.depths[node->depth].push_back(node);
+		if (bucket.deepest < node->depth)
+		{
+			bucket.deepest = node->depth;
+		}
+		// The heuristic is not required to be consistent, so a node may be cheaper than the last popped one.
+		if (lowest_ > node->heuristicCost)
+		{
+			lowest_ = node->heuristicCost;
+		}
+		++size_;
+	}
+	NodeType* pop()
+	{
+		// The nodes in the buckets are all cheaper than the ones over the cap.
+		if (size_ == 0)
+			return overflow_.pop();
+		while (buckets_[lowest_].deepest < 0)
+		{
+			++lowest_;
+		}
+		Bucket& bucket = buckets_[lowest_];
+		NodeType* node = bucket.depths[bucket.deepest].pop();
+		while (bucket.deepest >= 0 && bucket.depths[bucket.deepest].empty())
+		{
+			--bucket.deepest;
+		}
+		--size_;
+		return node;
+	}
+	// Empties the list, the memory of the buckets is kept.
+	void clear()
+	{
+		for (Bucket& bucket : buckets_)
+		{
+			for (; bucket.deepest >= 0; --bucket.deepest)
+			{
+				bucket.depths[bucket.deepest].clear();
+			}
+		}
+		lowest_ = 0;
+		size_ = 0;
+		overflow_.clear();
+	}
+	bool contains(NodeType const* /*node*/) const { return false; }
+	void decrease(NodeType* /*node*/) {}
+private:
+	// The nodes of one cost and depth, in the order they were pushed.
+	class NodeQueue
+	{
+	public:
+		bool empty() const { return head_ == nodes_.size(); }
+		void push_back(NodeType* node) { nodes_.push_back(node); }
+		NodeType* pop()
+		{
+			NodeType* node = nodes_[head_++];
+			if (head_ == nodes_.size())
+			{
+				clear();
+			}
+			return node;
+		}
+		void clear()
+		{
+			nodes_.clear();
+			head_ = 0;
+		}
+	private:
+		std::vector<NodeType*> nodes_;
+		size_t head_ = 0;
+	};
+
+	struct Bucket
+	{
+		// The nodes of the bucket by their depth.
+		std::vector<NodeQueue> depths;
+		// The highest depth with a node (-1 if the bucket is empty).
+		int deepest = -1;
+	};
+
+	std::vector<Bucket> buckets_;
+	// No bucket below this one has a node.
+	int lowest_ = 0;
+	// The number of the nodes in the buckets.
+	size_t size_ = 0;
+	// The nodes of the costs from maxBucketCost up.
+	BinaryHeapOpenList<NodeType> overflow_;
+};
+
+// An open list kept as a binary heap, in which every node knows its position (Node::openIndex).
+// The top node is moved out by pop and a node whose cost was decreased is moved up in place.
+template <typename NodeType>
+class IndexedHeapOpenList
+{
+public:
+	bool empty() const { return heap_.empty(); }
+	void push(NodeType* node)
+	{
+		heap_.push_back(node);
+		SiftUp(heap_.size() - 1);
+	}
+	NodeType* pop()
+	{
+		NodeType* node = heap_.front();
+		node->openIndex = -1;
+		NodeType* last = heap_.back();
+		heap_.pop_back();
+		if (!heap_.empty())
+		{
+			heap_.front() = last;
+			SiftDown(0);
+		}
+		return node;
+	}
+	void clear()
+	{
+		for (NodeType* node : heap_)
+		{
+			node->openIndex = -1;
+		}
+		heap_.clear();
+	}
+	bool contains(NodeType const* node) const { return node->openIndex >= 0; }
+	// Moves the node up after its heuristic cost was decreased.
+	void decrease(NodeType* node) { SiftUp(node->openIndex); }
+private:
+	static bool IsBetter(NodeType const* n1, NodeType const* n2)
+	{
+		return n1->heuristicCost < n2->heuristicCost ||
+			(n1->heuristicCost == n2->heuristicCost && n1->depth > n2->depth);
+	}
+	void Place(NodeType* node, size_t index)
+	{
+		heap_[index] = node;
+		node->openIndex = (int)index;
+	}
+	void SiftUp(size_t index)
+	{
+		NodeType* node = heap_[index];
+		while (index > 0)
+		{
+			size_t parent = (index - 1) / 2;
+			if (!IsBetter(node, heap_[parent]))
+				break;
+			Place(heap_[parent], index);
+			index = parent;
+		}
+		Place(node, index);
+	}
+	void SiftDown(size_t index)
+	{
+		NodeType* node = heap_[index];
+		for (;;)
+		{
+			size_t child = 2 * index + 1;
+			if (child >= heap_.size())
+				break;
+			if (child + 1 < heap_.size() && IsBetter(heap_[child + 1], heap_[child]))
+				++child;
+			if (!IsBetter(heap_[child], node))
+				break;
+			Place(heap_[child], index);
+			index = child;
+		}
+		Place(node, index);
+	}
+
+	std::vector<NodeType*> heap_;
+};
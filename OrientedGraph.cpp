@@ -1,28 +1,153 @@
 #include "OrientedGraph.hpp"
-#include <stack>
 #include <cassert>
+#include <cstddef>
+#include <stdexcept>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Returns the index of the lowest set bit of a non-zero word.
+static int LowestBit(std::uint64_t word)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return (int)index;
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+// Returns the number of set bits of the word.
+static int PopCount(std::uint64_t word)
+{
+#ifdef _MSC_VER
+    return (int)__popcnt64(word);
+#else
+    return __builtin_popcountll(word);
+#endif
+}
 
 OrientedGraph::OrientedGraph(int maxVertexCount)
 {
-	graph_.resize(maxVertexCount);
+	Reset(maxVertexCount);
+}
+
+void OrientedGraph::Reset(int vertexCount)
+{
+    vertexCount_ = vertexCount;
+    wordCount_ = (vertexCount + 63) / 64;
+    next_.assign(vertexCount_ * wordCount_, 0);
+    back_.assign(vertexCount_ * wordCount_, 0);
+    // The pair counts are initialized when an edge is added for the first time.
+    if (pairCount_.size() < vertexCount_ * vertexCount_)
+        pairCount_.resize(vertexCount_ * vertexCount_);
+    occupied_.assign(vertexCount_, 0);
+    loopsBroken_ = false;
+    layerCount_ = 0;
+    layerOrder_.clear();
 }
 
 void OrientedGraph::AddOrientedEdge(int v1, int v2)
 {
-    graph_[v1].next.insert(v2);
-    graph_[v2].back.insert(v1);
+    std::uint64_t& nextWord = next_[v1 * wordCount_ + v2 / 64];
+    std::uint64_t bit = 1ULL << (v2 % 64);
+    int& pairCount = pairCount_[v1 * vertexCount_ + v2];
+    if ((nextWord & bit) == 0)
+        pairCount = 0;
+    nextWord |= bit;
+    back_[v2 * wordCount_ + v1 / 64] |= 1ULL << (v1 % 64);
     if (v1 != v2)
-        pairCount_[{v1, v2}]++;
+        pairCount++;
+}
+
+int OrientedGraph::GetLoopCountBreakLoops()
+{
+#ifdef VERIFY_LOOP_BREAKING
+    std::vector<std::uint64_t> originalNext = next_;
+    std::vector<std::uint64_t> originalBack = back_;
+#endif
+
+    // A single depth first search, that erases every edge leading back to the recursion stack.
+    // The edges leading back from an unoccupied vertex close a loop that needs to be counted.
+    // This gives the same result as restarting the search after every erased loop, because erasing
+    // an edge to an already visited vertex never changes the order the search visits the vertices in.
+    visited_.assign(vertexCount_, 0);
+    recStack_.assign(vertexCount_, 0);
+    eraseStack_.clear();
+    searchStack_.clear();
+
+    int result = 0;
+    for (int root = 0; root < vertexCount_; ++root)
+    {
+        if (visited_[root])
+            continue;
+
+        visited_[root] = true;
+        recStack_[root] = true;
+        searchStack_.push_back({ root, 0, next_[root * wordCount_], eraseStack_.size() });
+
+        while (!searchStack_.empty())
+        {
+            SearchFrame& frame = searchStack_.back();
+            int v = frame.vertex;
+            while (frame.bits == 0 && frame.word + 1 < wordCount_)
+            {
+                frame.bits = next_[v * wordCount_ + ++frame.word];
+            }
+
+            if (frame.bits == 0)
+            {
+                // All the successors were searched, the collected edges of an occupied vertex can be erased.
+                for (std::size_t erase = frame.eraseStart; erase < eraseStack_.size(); ++erase)
+                {
+                    EraseEdge(v, eraseStack_[erase]);
+                }
+                eraseStack_.resize(frame.eraseStart);
+                recStack_[v] = false;
+                searchStack_.pop_back();
+                continue;
+            }
+
+            int i = frame.word * 64 + LowestBit(frame.bits);
+            frame.bits &= frame.bits - 1;
+            if (!visited_[i])
+            {
+                visited_[i] = true;
+                recStack_[i] = true;
+                searchStack_.push_back({ i, 0, next_[i * wordCount_], eraseStack_.size() });
+            }
+            else if (recStack_[i] && !occupied_[v])
+            {
+                EraseEdge(v, i);
+                ++result;
+            }
+            else if (recStack_[i])
+            {
+                eraseStack_.push_back(i);
+            }
+        }
+    }
+
+#ifdef VERIFY_LOOP_BREAKING
+    std::swap(next_, originalNext);
+    std::swap(back_, originalBack);
+    if (GetLoopCountBreakLoopsRestarting() != result || next_ != originalNext || back_ != originalBack)
+        throw std::runtime_error("The single pass loop breaking differs from the restarting one!");
+#endif
+
+    loopsBroken_ = true;
+    return result;
 }
 
-int OrientedGraph::GetLoopCountBreakLoops(const std::set<int>& occupiedPlaces)
+#ifdef VERIFY_LOOP_BREAKING
+int OrientedGraph::GetLoopCountBreakLoopsRestarting()
 {
     // Mark all the vertices as not visited and not part of recursion 
     // stack 
-    std::vector<bool> visited;
-    visited.resize(graph_.size());
-    std::vector<bool> recStack;
-    recStack.resize(graph_.size());
+    visited_.resize(vertexCount_);
+    recStack_.resize(vertexCount_);
 
     // Call the recursive helper function to detect cycle in different 
     // DFS trees 
@@ -30,15 +155,16 @@ int OrientedGraph::GetLoopCountBreakLoops(const std::set<int>& occupiedPlaces)
     int last = 0;
     do
     {
-        for (int i = 0; i < graph_.size(); ++i)
+        for (int i = 0; i < vertexCount_; ++i)
         {
-            visited[i] = false;
-            recStack[i] = false;
+            visited_[i] = false;
+            recStack_[i] = false;
         }
+        eraseStack_.clear();
         last = result;
-        for (int i = 0; i < graph_.size(); ++i)
+        for (int i = 0; i < vertexCount_; ++i)
         {
-            if (IsCyclic(occupiedPlaces, i, visited, recStack))
+            if (IsCyclic(i))
             {
                 ++result;
                 break;
@@ -46,105 +172,111 @@ int OrientedGraph::GetLoopCountBreakLoops(const std::set<int>& occupiedPlaces)
         }
     } while (last != result);
 
-    loopsBroken_ = true;
     return result;
 }
+#endif
 
 void OrientedGraph::EstablishLayerFlow()
 {
     assert(loopsBroken_);
-    std::set<int> ignoreSet;
 
-    for (int i = 0; i < graph_.size(); ++i)
+    // Layer the vertices by Kahn's algorithm: a vertex is in the layer following the last layer of its
+    // predecessors, the vertices without any edges are not in any layer.
+    layerMembership_.assign(vertexCount_, 0);
+    inDegree_.resize(vertexCount_);
+    layerOrder_.clear();
+    for (int i = 0; i < vertexCount_; ++i)
     {
-        if (graph_[i].next.empty() && graph_[i].back.empty())
+        inDegree_[i] = 0;
+        for (int word = 0; word < wordCount_; ++word)
+        {
+            inDegree_[i] += PopCount(back_[i * wordCount_ + word]);
+        }
+        if (inDegree_[i] == 0 && HasNext(i))
         {
-            ignoreSet.insert(i);
+            layerOrder_.push_back(i);
         }
     }
 
-    while (ignoreSet.size() < graph_.size())
+    layerCount_ = 0;
+    for (std::size_t head = 0; head < layerOrder_.size(); ++head)
     {
-        std::set<int> layer;
+        int element = layerOrder_[head];
+        int layer = layerMembership_[element];
+        if (layer + 1 > layerCount_)
+            layerCount_ = layer + 1;
 
-        for (int i = 0; i < graph_.size(); ++i)
+        for (int word = 0; word < wordCount_; ++word)
         {
-            if (ignoreSet.find(i) == ignoreSet.end())
+            for (std::uint64_t bits = next_[element * wordCount_ + word]; bits != 0; bits &= bits - 1)
             {
-                bool shouldBeInLayer = true;
-                for (int backNode : graph_[i].back)
-                {
-                    if (ignoreSet.find(backNode) == ignoreSet.end())
-                    {
-                        shouldBeInLayer = false;
-                        break;
-                    }
-                }
-                if (shouldBeInLayer)
-                {
-                    layerMembership_[i] = layers_.size();
-                    layer.insert(i);
-                }
+                int nextElement = word * 64 + LowestBit(bits);
+                if (layerMembership_[nextElement] < layer + 1)
+                    layerMembership_[nextElement] = layer + 1;
+                if (--inDegree_[nextElement] == 0)
+                    layerOrder_.push_back(nextElement);
             }
         }
-
-        for (int layerElement : layer)
-        {
-            ignoreSet.insert(layerElement);
-        }
-        layers_.push_back(layer);
     }
 
-    for (int layer = layers_.size() - 1; layer >= 0; --layer)
+    // Going from the last layer, move every vertex with successors that has none of them in the next layer
+    // one layer further. The vertices of one layer are not connected to each other, so their order does not matter.
+    // The queue order of Kahn's algorithm does not decrease in layers, so walking it backwards visits the layers from the last one.
+    for (std::size_t index = layerOrder_.size(); index-- > 0;)
     {
-        std::set<int> eraseList;
-        for (auto it = layers_[layer].begin(); it != layers_[layer].end(); ++it)
+        int element = layerOrder_[index];
+        int layer = layerMembership_[element];
+        if (!HasNext(element))
+            continue;
+
+        bool shouldBeMoved = true;
+        for (int word = 0; word < wordCount_ && shouldBeMoved; ++word)
         {
-            bool shouldBeMoved = true;
-            for (auto itNext = graph_[*it].next.begin(); itNext != graph_[*it].next.end(); ++itNext)
+            for (std::uint64_t bits = next_[element * wordCount_ + word]; bits != 0; bits &= bits - 1)
             {
-                if (layerMembership_[*itNext] == layer + 1)
+                if (layerMembership_[word * 64 + LowestBit(bits)] == layer + 1)
                 {
                     shouldBeMoved = false;
                     break;
                 }
             }
-            if (shouldBeMoved && !graph_[*it].next.empty())
-            {
-                ++layerMembership_[*it];
-                layers_[layer + 1].insert(*it);
-                eraseList.insert(*it);
-            }
         }
-        for (auto it = eraseList.begin(); it != eraseList.end(); ++it)
+        if (shouldBeMoved)
         {
-            layers_[layer].erase(*it);
+            ++layerMembership_[element];
         }
     }
 }
 
 int OrientedGraph::LimitLayerFlow(int limit)
 {
-    int result = 0;
-
-    int flow = 0;
-    for (const auto& layer : layers_)
+    // Sum the flow leaving each layer (the layers emptied by moving their vertices still count).
+    layerFlow_.assign(layerCount_, 0);
+    for (int element : layerOrder_)
     {
-        for (const auto& element : layer)
+        int flow = 0;
+        for (int word = 0; word < wordCount_; ++word)
         {
-            for (const auto& nextElement : graph_[element].next)
+            for (std::uint64_t bits = next_[element * wordCount_ + word]; bits != 0; bits &= bits - 1)
             {
-                flow += pairCount_[{element, nextElement}];
+                flow += pairCount_[element * vertexCount_ + word * 64 + LowestBit(bits)];
             }
-            for (const auto& backElement : graph_[element].back)
+            for (std::uint64_t bits = back_[element * wordCount_ + word]; bits != 0; bits &= bits - 1)
             {
-                flow -= pairCount_[{backElement, element}];
+                flow -= pairCount_[(word * 64 + LowestBit(bits)) * vertexCount_ + element];
             }
         }
-        result += (flow - 1) / limit;
+        layerFlow_[layerMembership_[element]] += flow;
     }
 
-    int bestResult = result;
+    int result = 0;
+
+    int flow = 0;
+    for (int layer = 0; layer < layerCount_; ++layer)
+    {
+        flow += layerFlow_[layer];
+        result += (flow - 1) / limit;
+    }
 
     // At this point, it is possible that the layer configuration is still not optimal.
     // If one was to move multiple nodes connected to each other at the same time, it might get a become a better result.
@@ -153,51 +285,83 @@ int OrientedGraph::LimitLayerFlow(int limit)
     return result;
 }
 
-bool OrientedGraph::IsCyclic(const std::set<int>& occupiedPlaces, int v, std::vector<bool>& visited, std::vector<bool>& recStack)
+#ifdef VERIFY_LOOP_BREAKING
+bool OrientedGraph::IsCyclic(int v)
 {
-    if (visited[v] == false)
+    if (visited_[v] == false)
     {
         // Mark the current node as visited and part of recursion stack 
-        visited[v] = true;
-        recStack[v] = true;
+        visited_[v] = true;
+        recStack_[v] = true;
 
-        std::set<int> eraseSet;
+        // The edges from an occupied vertex back to the recursion stack are erased without being counted,
+        // they are collected on the erase stack above this frame.
+        std::size_t eraseStart = eraseStack_.size();
         // Recur for all the vertices adjacent to this vertex 
-        for (auto i = graph_[v].next.begin(); i != graph_[v].next.end(); ++i)
+        for (int word = 0; word < wordCount_; ++word)
         {
-            if (!visited[*i] && IsCyclic(occupiedPlaces, *i, visited, recStack))
+            for (std::uint64_t bits = next_[v * wordCount_ + word]; bits != 0; bits &= bits - 1)
             {
-                for (auto&& eraseElement : eraseSet)
+                int i = word * 64 + LowestBit(bits);
+                if (!visited_[i] && IsCyclic(i))
                 {
-                    graph_[v].next.erase(eraseElement);
-                    graph_[eraseElement].back.erase(v);
+                    for (std::size_t erase = eraseStart; erase < eraseStack_.size(); ++erase)
+                    {
+                        EraseEdge(v, eraseStack_[erase]);
+                    }
+                    eraseStack_.resize(eraseStart);
+                    return true;
                 }
-                return true;
-            }
-            else if (recStack[*i] && occupiedPlaces.find(v) == occupiedPlaces.end())
-            {
-                int element = *i;
-                graph_[v].next.erase(element);
-                graph_[element].back.erase(v);
-                for (auto&& eraseElement : eraseSet)
+                else if (recStack_[i] && !occupied_[v])
                 {
-                    graph_[v].next.erase(eraseElement);
-                    graph_[eraseElement].back.erase(v);
+                    EraseEdge(v, i);
+                    for (std::size_t erase = eraseStart; erase < eraseStack_.size(); ++erase)
+                    {
+                        EraseEdge(v, eraseStack_[erase]);
+                    }
+                    eraseStack_.resize(eraseStart);
+                    return true;
+                }
+                else if (recStack_[i])
+                {
+                    eraseStack_.push_back(i);
                 }
-                return true;
-            }
-            else if (recStack[*i])
-            {
-                eraseSet.insert(*i);
             }
         }
 
-        for (auto&& eraseElement : eraseSet)
+        for (std::size_t erase = eraseStart; erase < eraseStack_.size(); ++erase)
         {
-            graph_[v].next.erase(eraseElement);
-            graph_[eraseElement].back.erase(v);
+            EraseEdge(v, eraseStack_[erase]);
         }
+        eraseStack_.resize(eraseStart);
+    }
+    recStack_[v] = false;  // remove the vertex from recursion stack
+    return false;
+}
+#endif
+
+bool OrientedGraph::HasNext(int v) const
+{
+    for (int word = 0; word < wordCount_; ++word)
+    {
+        if (next_[v * wordCount_ + word] != 0)
+            return true;
     }
-    recStack[v] = false;  // remove the vertex from recursion stack
     return false;
 }
+
+bool OrientedGraph::HasBack(int v) const
+{
+    for (int word = 0; word < wordCount_; ++word)
+    {
+        if (back_[v * wordCount_ + word] != 0)
+            return true;
+    }
+    return false;
+}
+
+void OrientedGraph::EraseEdge(int v1, int v2)
+{
+    next_[v1 * wordCount_ + v2 / 64] &= ~(1ULL << (v2 % 64));
+    back_[v2 * wordCount_ + v1 / 64] &= ~(1ULL << (v1 % 64));
+}
@@ -1,28 +1,67 @@
 #pragma once
 #include <vector>
-#include <set>
-#include <map>
+#include <cstdint>
+#include <cstddef>
 
-struct OrientedGraphNode
-{
-	std::set<int> next;
-	std::set<int> back;
-};
+// Checks every loop breaking against the original algorithm, which restarts the search after each erased loop.
+// Tests/LoopBreakingTest defines it to compare the two on random graphs.
+//#define VERIFY_LOOP_BREAKING
 
+// A small oriented graph stored as dense bit rows. The graph is meant to be reused: Reset keeps
+// the allocated memory, so a graph rebuilt for every heuristic evaluation does not allocate.
 class OrientedGraph
 {
 public:
+	OrientedGraph() = default;
 	OrientedGraph(int maxVertexCount);
+	// Removes all the edges and marks and sets the number of vertices.
+	void Reset(int vertexCount);
 	void AddOrientedEdge(int v1, int v2);
-	int GetLoopCountBreakLoops(const std::set<int>& occupiedPlaces);
+	// Marks the vertex as occupied, i.e. loops through it do not need to be counted.
+	void SetOccupied(int v) { occupied_[v] = true; }
+	bool IsOccupied(int v) const { return occupied_[v] != 0; }
+	int GetLoopCountBreakLoops();
 	// IMPORTANT: To be used only after the loops are broken.
 	void EstablishLayerFlow();
 	int LimitLayerFlow(int limit);
 private:
-	bool IsCyclic(const std::set<int>& occupiedPlaces, int v, std::vector<bool>& visited, std::vector<bool>& recStack);
-	std::vector<OrientedGraphNode> graph_;
-	std::map<std::pair<int, int>, int> pairCount_;
+#ifdef VERIFY_LOOP_BREAKING
+	int GetLoopCountBreakLoopsRestarting();
+	bool IsCyclic(int v);
+#endif
+	bool HasNext(int v) const;
+	bool HasBack(int v) const;
+	void EraseEdge(int v1, int v2);
+
+	int vertexCount_ = 0;
+	// The number of 64-bit words in one row of the adjacency matrices.
+	int wordCount_ = 0;
+	std::vector<std::uint64_t> next_;
+	std::vector<std::uint64_t> back_;
+	// The number of times each edge was added, only valid for the edges that are present.
+	std::vector<int> pairCount_;
+	std::vector<char> occupied_;
 	bool loopsBroken_ = false;
-	std::vector<std::set<int>> layers_;
-	std::map<int, int> layerMembership_;
+
+	// Scratch buffers of the algorithms.
+	std::vector<char> visited_;
+	std::vector<char> recStack_;
+	std::vector<int> eraseStack_;
+	struct SearchFrame
+	{
+		int vertex;
+		// The word of the successor row being searched and its successors that were not searched yet.
+		int word;
+		std::uint64_t bits;
+		// Where the edges to be erased by this vertex start on the erase stack.
+		std::size_t eraseStart;
+	};
+	std::vector<SearchFrame> searchStack_;
+	std::vector<int> inDegree_;
+
+	int layerCount_ = 0;
+	// The vertices with edges in the order Kahn's algorithm layered them.
+	std::vector<int> layerOrder_;
+	std::vector<int> layerMembership_;
+	std::vector<int> layerFlow_;
 };
@@ -0,0 +1,99 @@
+#include "SearchArena.hpp"
+#include <cstdint>
+
+thread_local SearchArena* SearchArena::current_ = nullptr;
+
+// The header in front of the memory of AllocateObject, it keeps the alignment of the object.
+union ObjectHeader
+{
+	bool inArena;
+	std::max_align_t alignment;
+};
+
+SearchArena::~SearchArena()
+{
+	Reset();
+	for (char* chunk : chunks_)
+	{
+		delete[] chunk;
+	}
+}
+
+void* SearchArena::Allocate(std::size_t size, std::size_t alignment)
+{
+	if (size + alignment > chunkSize_)
+	{
+		char* memory = new char[size + alignment];
+		largeObjects_.push_back(memory);
+		bytesUsed_ += size + alignment;
+		return (void*)(((std::uintptr_t)memory + alignment - 1) & ~(std::uintptr_t)(alignment - 1));
+	}
+
+	std::uintptr_t address = ((std::uintptr_t)position_ + alignment - 1) & ~(std::uintptr_t)(alignment - 1);
+	if (position_ == nullptr || address + size > (std::uintptr_t)end_)
+	{
+		// Continue in the next chunk, allocate it if it was not needed before.
+		if (position_ != nullptr)
+			++currentChunk_;
+		if (currentChunk_ == chunks_.size())
+			chunks_.push_back(new char[chunkSize_]);
+		position_ = chunks_[currentChunk_];
+		end_ = position_ + chunkSize_;
+		address = ((std::uintptr_t)position_ + alignment - 1) & ~(std::uintptr_t)(alignment - 1);
+	}
+	bytesUsed_ += (address + size) - (std::uintptr_t)position_;
+	position_ = (char*)(address + size);
+	return (void*)address;
+}
+
+void SearchArena::Reset()
+{
+	for (char* memory : largeObjects_)
+	{
+		delete[] memory;
+	}
+	largeObjects_.clear();
+	currentChunk_ = 0;
+	position_ = chunks_.empty() ? nullptr : chunks_[0];
+	end_ = chunks_.empty() ? nullptr : chunks_[0] + chunkSize_;
+	bytesUsed_ = 0;
+}
+
+void SearchArena::Release()
+{
+	Reset();
+	for (std::size_t chunk = 1; chunk < chunks_.size(); ++chunk)
+	{
+		delete[] chunks_[chunk];
+	}
+	if (chunks_.size() > 1)
+		chunks_.resize(1);
+}
+
+void* SearchArena::AllocateObject(std::size_t size)
+{
+	ObjectHeader* header;
+	if (current_)
+	{
+		header = (ObjectHeader*)current_->Allocate(sizeof(ObjectHeader) + size);
+		header->inArena = true;
+	}
+	else
+	{
+		header = (ObjectHeader*)::operator new(sizeof(ObjectHeader) + size);
+		header->inArena = false;
+	}
+	return header + 1;
+}
+
+void SearchArena::FreeObject(void* memory)
+{
+	if (memory == nullptr)
+		return;
+
+	ObjectHeader* header = (ObjectHeader*)memory - 1;
+	if (!header->inArena)
+	{
+		::operator delete(header);
+	}
+}
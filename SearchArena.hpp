@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+// A bump allocator for the objects of one search. The objects are never freed one by one,
+// Reset releases all of them at once without calling their destructors.
+class SearchArena
+{
+public:
+	// The default size of the memory chunks the objects are allocated from.
+	static const std::size_t defaultChunkSize = 1 << 20;
+
+	SearchArena(std::size_t chunkSize = defaultChunkSize) : chunkSize_(chunkSize) {}
+	~SearchArena();
+	SearchArena(const SearchArena&) = delete;
+	SearchArena& operator=(const SearchArena&) = delete;
+
+	// Returns uninitialized memory, valid until the next Reset.
+	void* Allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+	// Allocates and constructs an object, its destructor is never called.
+	template <typename T, typename... Args>
+	T* New(Args&&... args) { return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...); }
+	// Releases all the allocated objects, the chunks are kept to be reused.
+	void Reset();
+	// Releases all the allocated objects and frees the chunks, except the first one.
+	void Release();
+
+	// The number of bytes allocated since the last Reset.
+	std::size_t BytesUsed() const { return bytesUsed_; }
+
+	// Returns the arena the searched states and actions of this thread are allocated from (nullptr for the heap).
+	static SearchArena* Current() { return current_; }
+
+	// Makes the arena the current one for its lifetime, nullptr makes the heap current.
+	class Scope
+	{
+	public:
+		Scope(SearchArena* arena) : previous_(current_) { current_ = arena; }
+		~Scope() { current_ = previous_; }
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	private:
+		SearchArena* previous_;
+	};
+
+	// Allocates memory from the current arena, or from the heap if there is none. The memory is remembered
+	// to be released by FreeObject, which does nothing for the memory of an arena.
+	static void* AllocateObject(std::size_t size);
+	static void FreeObject(void* memory);
+private:
+	std::size_t chunkSize_;
+	std::vector<char*> chunks_;
+	// The chunk the objects are allocated from, the following chunks are free.
+	std::size_t currentChunk_ = 0;
+	// The objects larger than a chunk, allocated separately.
+	std::vector<char*> largeObjects_;
+	char* position_ = nullptr;
+	char* end_ = nullptr;
+	std::size_t bytesUsed_ = 0;
+
+	static thread_local SearchArena* current_;
+};
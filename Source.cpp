@@ -1,6 +1,8 @@
 #include "LogProblem.hpp"
 #include "AStarInterface.hpp"
-#include "AStarSolver.hpp"
+#include "BasicAStarSolver.hpp"
+#include "DecompositionSolver.hpp"
+#include "HeuristicEngine.hpp"
 #include <iostream>
 #include <fstream>
 #include <chrono>
@@ -26,16 +28,39 @@ int main(int argc, char* argv[])
 		return 0;
 	}
 
+	// The heuristic of the following inputs: "default" or the name of a heuristic engine.
+	std::string heuristic = "default";
+	// Whether the following inputs are solved by the DecompositionSolver.
+	bool decompose = false;
+
 	std::ofstream ofs("res_time.txt");
 	for (int i = 1; i < argc; ++i)
 	{
+		if (std::string(argv[i]) == "--heuristic" && i + 1 < argc)
+		{
+			heuristic = argv[++i];
+			continue;
+		}
+		if (std::string(argv[i]) == "--decompose")
+		{
+			decompose = true;
+			continue;
+		}
+
 		LogProblem problem(argv[i]);
-		AStarSolver solver;
-		std::vector<std::unique_ptr<IAction>> solution;
+		std::shared_ptr<HeuristicEngine> engine;
+		if (heuristic != "default")
+		{
+			engine = HeuristicEngine::Create(heuristic, problem.GetSetting(), problem.InitialState());
+			problem.SetHeuristicEngine(engine);
+		}
+		BasicAStarSolver<LogProblem> solver;
+		DecompositionSolver decompositionSolver;
+		std::vector<Action> solution;
 
 		const auto start = std::chrono::high_resolution_clock::now();
 		std::cout << std::endl << '*' << argv[i] << std::endl;
-		int cost = solver.Solve(problem, solution);
+		int cost = decompose ? decompositionSolver.Solve(problem, solution) : solver.Solve(problem, solution);
 		const auto end = std::chrono::high_resolution_clock::now();
 		const auto timeElapsedNano = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
 
@@ -44,6 +69,14 @@ int main(int argc, char* argv[])
 		//std::cout << std::endl << "-- cost: " << cost << std::endl;
 
 		std::cout << "in " << timeElapsedNano / 1000000.f << " ms" << std::endl;
+		const AStarStatistics& statistics = decompose ? decompositionSolver.GetStatistics() : solver.GetStatistics();
+		std::cout << "peak arena usage: " << statistics.peakArenaBytes << " bytes" << std::endl;
+		std::cout << "city term cache hit rate: " << problem.GetSetting().GetCityTermCache().HitRate() << std::endl;
+		if (engine)
+		{
+			std::cout << heuristic << ": " << engine->Evaluations() << " evaluations, "
+				<< engine->MicrosecondsPerEvaluation() << " us per evaluation" << std::endl;
+		}
 		ofs << timeElapsedNano / 1000000.f << std::endl;
 	}
 	ofs.close();
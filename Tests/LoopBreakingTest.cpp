@@ -0,0 +1,56 @@
+// Compares the single pass loop breaking of OrientedGraph with the original restarting one on random graphs.
+// The project defines VERIFY_LOOP_BREAKING, so every GetLoopCountBreakLoops runs both implementations
+// and throws if the loop counts or the adjacency rows they leave differ.
+#include "OrientedGraph.hpp"
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+#ifndef VERIFY_LOOP_BREAKING
+#error "The test needs VERIFY_LOOP_BREAKING to be defined for the whole project."
+#endif
+
+int main(int argc, char* argv[])
+{
+	int graphCount = argc > 1 ? std::stoi(argv[1]) : 200000;
+	std::mt19937 random(2020);
+
+	OrientedGraph graph;
+	long long loopCount = 0;
+	for (int test = 0; test < graphCount; ++test)
+	{
+		// Mostly small graphs like the ones of the heuristic, every tenth wider than one 64-bit word.
+		int vertexCount = test % 10 == 0
+			? std::uniform_int_distribution<int>(65, 160)(random)
+			: std::uniform_int_distribution<int>(1, 16)(random);
+		int edgeCount = std::uniform_int_distribution<int>(0, 3 * vertexCount)(random);
+		std::uniform_int_distribution<int> vertex(0, vertexCount - 1);
+
+		graph.Reset(vertexCount);
+		for (int edge = 0; edge < edgeCount; ++edge)
+		{
+			// Self-loops and repeated edges are generated as well.
+			graph.AddOrientedEdge(vertex(random), vertex(random));
+		}
+		for (int v = 0; v < vertexCount; ++v)
+		{
+			if (random() % 4 == 0)
+			{
+				graph.SetOccupied(v);
+			}
+		}
+
+		try
+		{
+			loopCount += graph.GetLoopCountBreakLoops();
+		}
+		catch (const std::runtime_error& error)
+		{
+			std::cout << "Graph " << test << ": " << error.what() << std::endl;
+			return 1;
+		}
+	}
+
+	std::cout << graphCount << " graphs, " << loopCount << " loops broken, no differences." << std::endl;
+	return 0;
+}
@@ -0,0 +1,215 @@
+// Solves the inputs by every mode of BasicAStarSolver, over LogProblem and over the virtual interface
+// (with the lazy and the eager expansion), and checks that every plan reaches the goal at the cost returned.
+// With the admissible lmcut heuristic, the modes that are optimal for it must also find plans as cheap as Solve.
+// Without arguments, the bundled inputs are read relative to the Tests directory.
+#include "BasicAStarSolver.hpp"
+#include "HeuristicEngine.hpp"
+#include "InterfaceProblem.hpp"
+#include "LogProblem.hpp"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Replays the plan from the initial configuration, returns false if it does not reach the goal at the cost.
+static bool CheckPlan(const LogProblem& problem, const std::vector<Action>& plan, int cost)
+{
+	LogConfiguration configuration(problem.InitialState());
+	int planCost = 0;
+	for (const Action& action : plan)
+	{
+		configuration.ApplyAction(action, problem.GetSetting());
+		planCost += action.Cost();
+	}
+	return problem.IsGoalState(configuration) && planCost == cost;
+}
+
+// Pushes nodes of costs below and over the bucket cap of BucketOpenList and checks that they pop in order.
+static bool CheckBucketOverflow()
+{
+	using TestNode = Node<LogConfiguration, Action>;
+	const int costs[] = { BucketOpenList<TestNode>::maxBucketCost + 5, 7, BasicAStarSolver<LogProblem>::deadEndHeuristic,
+		BucketOpenList<TestNode>::maxBucketCost, 3 };
+	std::vector<std::unique_ptr<TestNode>> nodes;
+	BucketOpenList<TestNode> openList;
+	for (int cost : costs)
+	{
+		nodes.emplace_back(new TestNode(LogConfiguration()));
+		nodes.back()->heuristicCost = cost;
+		openList.push(nodes.back().get());
+	}
+	int lastCost = -1;
+	size_t popped = 0;
+	for (; !openList.empty(); ++popped)
+	{
+		int cost = openList.pop()->heuristicCost;
+		if (cost < lastCost)
+			return false;
+		lastCost = cost;
+	}
+	return popped == nodes.size();
+}
+
+// Solves the input twice by one solver with the indexed heap, the second search starts with the open list
+// the first one left. Without the transposition table, the first search takes more than one chunk of the arena,
+// so that its nodes are freed when it ends (a use of the freed nodes shows under AddressSanitizer).
+static bool CheckSolverReuse(const std::string& input)
+{
+	LogProblem problem(input);
+	BasicAStarSolver<LogProblem> solver;
+	solver.SetVerbose(false);
+	solver.SetOpenListType(BasicAStarSolver<LogProblem>::OpenListType::INDEXED_HEAP);
+	solver.SetTranspositionTableLimit(0);
+	std::vector<Action> firstPlan;
+	int firstCost = solver.Solve(problem, firstPlan);
+	std::vector<Action> plan;
+	int cost = solver.Solve(problem, plan);
+	return cost != INT32_MAX && cost == firstCost && CheckPlan(problem, firstPlan, firstCost) && CheckPlan(problem, plan, cost);
+}
+
+static int SolveInterface(const LogProblem& problem, bool lazyExpansion, bool partialOrderReduction,
+	std::vector<Action>& plan)
+{
+	InterfaceProblem interfaceProblem(problem, lazyExpansion);
+	BasicAStarSolver<InterfaceProblem> solver;
+	solver.SetVerbose(false);
+	solver.SetPartialOrderReduction(partialOrderReduction);
+	std::vector<InterfaceAction> actions;
+	int cost = solver.Solve(interfaceProblem, actions);
+	for (InterfaceAction& action : actions)
+	{
+		std::unique_ptr<IAction> released(action.Release());
+		plan.push_back(static_cast<LogAction&>(*released).action);
+	}
+	return cost;
+}
+
+int main(int argc, char* argv[])
+{
+	std::vector<std::string> inputs(argv + 1, argv + argc);
+	// The depth-first search with lmcut takes minutes on the bigger inputs.
+	std::vector<std::string> lmcutInputs = inputs;
+	std::vector<std::string> symmetryInputs = inputs;
+	if (inputs.empty())
+	{
+		inputs = { "../in/places/input3.txt", "../in/places/input10.txt", "../in/cities/input2.txt",
+			"../in/cities/input8.txt" };
+		lmcutInputs = { "../in/places/input3.txt", "../in/cities/input2.txt" };
+		// The indexed heap moved the nodes of symmetric states to new paths in this one.
+		symmetryInputs = inputs;
+		symmetryInputs.push_back("symmetric.txt");
+	}
+
+	using Mode = std::function<int(const LogProblem&, std::vector<Action>&)>;
+	auto direct = [](std::function<int(BasicAStarSolver<LogProblem>&, const LogProblem&, std::vector<Action>&)> solve)
+	{
+		return [solve](const LogProblem& problem, std::vector<Action>& plan)
+		{
+			BasicAStarSolver<LogProblem> solver;
+			solver.SetVerbose(false);
+			return solve(solver, problem, plan);
+		};
+	};
+	std::vector<std::pair<std::string, Mode>> modes = {
+		{ "Solve", direct([](BasicAStarSolver<LogProblem>& solver, const LogProblem& problem, std::vector<Action>& plan)
+			{ return solver.Solve(problem, plan); }) },
+		{ "Solve, bucket queue", direct([](BasicAStarSolver<LogProblem>& solver, const LogProblem& problem, std::vector<Action>& plan)
+			{ solver.SetOpenListType(BasicAStarSolver<LogProblem>::OpenListType::BUCKET_QUEUE); return solver.Solve(problem, plan); }) },
+		{ "Solve, indexed heap", direct([](BasicAStarSolver<LogProblem>& solver, const LogProblem& problem, std::vector<Action>& plan)
+			{ solver.SetOpenListType(BasicAStarSolver<LogProblem>::OpenListType::INDEXED_HEAP); return solver.Solve(problem, plan); }) },
+		{ "Solve, retained fringe", direct([](BasicAStarSolver<LogProblem>& solver, const LogProblem& problem, std::vector<Action>& plan)
+			{ solver.SetRetainFringe(true); return solver.Solve(problem, plan); }) },
+		{ "Solve, partial order reduction", direct([](BasicAStarSolver<LogProblem>& solver, const LogProblem& problem, std::vector<Action>& plan)
+			{ solver.SetPartialOrderReduction(true); return solver.Solve(problem, plan); }) },
+		{ "SolveDepthFirst", direct([](BasicAStarSolver<LogProblem>& solver, const LogProblem& problem, std::vector<Action>& plan)
+			{ return solver.SolveDepthFirst(problem, plan); }) },
+		{ "SolveDepthFirst, partial order reduction", direct([](BasicAStarSolver<LogProblem>& solver, const LogProblem& problem, std::vector<Action>& plan)
+			{ solver.SetPartialOrderReduction(true); return solver.SolveDepthFirst(problem, plan); }) },
+		{ "SolveParallel", direct([](BasicAStarSolver<LogProblem>& solver, const LogProblem& problem, std::vector<Action>& plan)
+			{ return solver.SolveParallel(problem, plan, 2); }) },
+		{ "interface, lazy", [](const LogProblem& problem, std::vector<Action>& plan)
+			{ return SolveInterface(problem, true, false, plan); } },
+		{ "interface, eager", [](const LogProblem& problem, std::vector<Action>& plan)
+			{ return SolveInterface(problem, false, false, plan); } },
+		{ "interface, lazy, partial order reduction", [](const LogProblem& problem, std::vector<Action>& plan)
+			{ return SolveInterface(problem, true, true, plan); } },
+		{ "interface, eager, partial order reduction", [](const LogProblem& problem, std::vector<Action>& plan)
+			{ return SolveInterface(problem, false, true, plan); } },
+	};
+
+	int failures = 0;
+	bool overflowValid = CheckBucketOverflow();
+	std::cout << "bucket queue over the cap" << (overflowValid ? "" : " FAILED") << std::endl;
+	failures += !overflowValid;
+	bool reuseValid = CheckSolverReuse("../in/places/input19.txt");
+	std::cout << "solver reused with the indexed heap" << (reuseValid ? "" : " FAILED") << std::endl;
+	failures += !reuseValid;
+
+	for (const std::string& input : inputs)
+	{
+		LogProblem problem(input);
+		for (auto&& mode : modes)
+		{
+			std::vector<Action> plan;
+			int cost = mode.second(problem, plan);
+			bool valid = cost != INT32_MAX && CheckPlan(problem, plan, cost);
+			std::cout << input << ", " << mode.first << ": cost " << cost << (valid ? "" : " FAILED") << std::endl;
+			failures += !valid;
+		}
+	}
+
+	// With the symmetry reduction, a state reached again by a cheaper path may be a symmetric one,
+	// the indexed heap has to move the node to it with the new path.
+	for (const std::string& input : symmetryInputs)
+	{
+		LogProblem problem(input);
+		problem.SetSymmetryReduction(true);
+		BasicAStarSolver<LogProblem> solver;
+		solver.SetVerbose(false);
+		solver.SetOpenListType(BasicAStarSolver<LogProblem>::OpenListType::INDEXED_HEAP);
+		std::vector<Action> plan;
+		int cost = solver.Solve(problem, plan);
+		bool valid = cost != INT32_MAX && CheckPlan(problem, plan, cost);
+		std::cout << input << ", symmetry reduction, indexed heap: cost " << cost << " (" <<
+			solver.GetStatistics().decreasedKeys << " decreased keys)" << (valid ? "" : " FAILED") << std::endl;
+		failures += !valid;
+	}
+
+	auto findMode = [&modes](const std::string& name)
+	{
+		return std::find_if(modes.begin(), modes.end(),
+			[&name](const std::pair<std::string, Mode>& mode) { return mode.first == name; })->second;
+	};
+	// The modes that are optimal with an admissible heuristic.
+	std::vector<std::pair<std::string, Mode>> optimalModes = {
+		{ "SolveDepthFirst", findMode("SolveDepthFirst") },
+		{ "SolveParallel", findMode("SolveParallel") },
+		// The heuristic is weighted 5, 4, ... 1, the dead ends have to stay dead ends.
+		{ "SolveAnytime", direct([](BasicAStarSolver<LogProblem>& solver, const LogProblem& problem, std::vector<Action>& plan)
+			{ return solver.SolveAnytime(problem, plan, std::chrono::minutes(1)); }) },
+	};
+	for (const std::string& input : lmcutInputs)
+	{
+		LogProblem problem(input);
+		problem.SetHeuristicEngine(HeuristicEngine::Create("lmcut", problem.GetSetting(), problem.InitialState()));
+		std::vector<Action> plan;
+		int optimalCost = findMode("Solve")(problem, plan);
+		bool valid = optimalCost != INT32_MAX && CheckPlan(problem, plan, optimalCost);
+		std::cout << input << ", lmcut, Solve: cost " << optimalCost << (valid ? "" : " FAILED") << std::endl;
+		failures += !valid;
+		for (auto&& mode : optimalModes)
+		{
+			plan.clear();
+			int cost = mode.second(problem, plan);
+			valid = cost == optimalCost && CheckPlan(problem, plan, cost);
+			std::cout << input << ", lmcut, " << mode.first << ": cost " << cost << (valid ? "" : " FAILED") << std::endl;
+			failures += !valid;
+		}
+	}
+
+	std::cout << failures << " failures." << std::endl;
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+ThreadPool::ThreadPool(unsigned threadCount)
+{
+	if (threadCount == 0)
+	{
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+	for (unsigned i = 0; i < threadCount; ++i)
+	{
+		threads_.emplace_back(&ThreadPool::Run, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopping_ = true;
+	}
+	wakeUp_.notify_all();
+	for (std::thread& thread : threads_)
+	{
+		thread.join();
+	}
+}
+
+std::future<void> ThreadPool::Submit(std::function<void()> task)
+{
+	auto packagedTask = std::make_shared<std::packaged_task<void()>>(std::move(task));
+	std::future<void> future = packagedTask->get_future();
+	Enqueue([packagedTask]() { (*packagedTask)(); });
+	return future;
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& task)
+{
+	if (count == 0)
+		return;
+
+	// The state of the loop is shared with the helping tasks, which can start after the loop is done.
+	// Those find no index left and never touch the task.
+	struct Loop
+	{
+		const std::function<void(size_t)>* task;
+		size_t count;
+		std::atomic<size_t> next{ 0 };
+		std::atomic<size_t> done{ 0 };
+		std::mutex mutex;
+		std::condition_variable finished;
+		std::exception_ptr exception;
+	};
+	auto loop = std::make_shared<Loop>();
+	loop->task = &task;
+	loop->count = count;
+
+	auto work = [loop]()
+	{
+		for (size_t i = loop->next++; i < loop->count; i = loop->next++)
+		{
+			try
+			{
+				(*loop->task)(i);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(loop->mutex);
+				if (!loop->exception)
+				{
+					loop->exception = std::current_exception();
+				}
+			}
+			if (++loop->done == loop->count)
+			{
+				std::lock_guard<std::mutex> lock(loop->mutex);
+				loop->finished.notify_all();
+			}
+		}
+	};
+
+	size_t helperCount = std::min<size_t>(threads_.size(), count - 1);
+	for (size_t i = 0; i < helperCount; ++i)
+	{
+		Enqueue(work);
+	}
+	work();
+
+	std::unique_lock<std::mutex> lock(loop->mutex);
+	loop->finished.wait(lock, [&loop]() { return loop->done == loop->count; });
+	if (loop->exception)
+		std::rethrow_exception(loop->exception);
+}
+
+ThreadPool& ThreadPool::Shared()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+void ThreadPool::Enqueue(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		tasks_.push(std::move(task));
+	}
+	wakeUp_.notify_one();
+}
+
+void ThreadPool::Run()
+{
+	for (;;)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			wakeUp_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+			if (tasks_.empty())
+				return;
+			task = std::move(tasks_.front());
+			tasks_.pop();
+		}
+		task();
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// A fixed set of threads running the submitted tasks in the order they were submitted.
+class ThreadPool
+{
+public:
+	// Starts threadCount threads, a thread per core if 0.
+	explicit ThreadPool(unsigned threadCount = 0);
+	// Runs the tasks still waiting and stops the threads.
+	~ThreadPool();
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	unsigned ThreadCount() const { return (unsigned)threads_.size(); }
+	// Runs the task on a thread of the pool, the future gets ready (or gets the exception of the task) when it is done.
+	std::future<void> Submit(std::function<void()> task);
+	// Calls task(i) for every i from 0 to count - 1 on the threads of the pool and on the calling thread,
+	// and returns when all the calls are done. The calling thread never waits for a free thread of the pool,
+	// so it can be called from the tasks of the pool and from several threads at once.
+	// If a call throws, the other calls still run and the first exception is rethrown.
+	void ParallelFor(size_t count, const std::function<void(size_t)>& task);
+
+	// Returns the pool shared by the whole program, with a thread per core.
+	static ThreadPool& Shared();
+private:
+	void Enqueue(std::function<void()> task);
+	void Run();
+
+	std::vector<std::thread> threads_;
+	std::mutex mutex_;
+	std::condition_variable wakeUp_;
+	std::queue<std::function<void()>> tasks_;
+	bool stopping_ = false;
+};